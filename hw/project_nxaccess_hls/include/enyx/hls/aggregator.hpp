@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "word_traits.hpp"
+
+namespace enyx {
+namespace hls_tools {
+
+/// Aggregates the packets of a words stream (delimited by 'last') into packets of up to
+/// MaxWordCount words. An output packet is flushed when the next input packet may not fit
+/// (MaxInputWordCount: words of the longest input packet), or when no word came for Timeout
+/// cycles after an input packet end.
+/// Each word is held for a cycle, the time to know whether an input packet end is also the
+/// end of the output packet.
+template<typename Id,
+         typename Word,
+         std::size_t MaxWordCount,
+         std::size_t MaxInputWordCount,
+         std::size_t Timeout>
+class aggregator
+{
+public:
+    typedef Word data_in_word;
+    typedef Word data_out_word;
+    static const std::size_t max_word_count = MaxWordCount;
+
+public:
+    static void
+    p_aggregate(hls::stream<data_in_word> & in,
+                hls::stream<data_out_word> & out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        static data_in_word held_word; /// last word read, not written yet
+        static bool held = false;
+        #pragma HLS RESET variable=held
+        static ap_uint<16> packet_word_count = 0; /// words written in the output packet
+        #pragma HLS RESET variable=packet_word_count
+        static ap_uint<16> idle_cycles = 0; /// cycles since the held input packet end was read
+        #pragma HLS RESET variable=idle_cycles
+
+        if (! in.empty()) {
+            data_in_word const word_in = in.read();
+            if (held) {
+                data_out_word word_out = held_word;
+                if (is_last(held_word))
+                    word_out.last = packet_word_count + 1 + MaxInputWordCount > MaxWordCount;
+                out.write(word_out);
+                packet_word_count = word_out.last ? ap_uint<16>(0) : ap_uint<16>(packet_word_count + 1);
+            }
+            held_word = word_in;
+            held = true;
+            idle_cycles = 0;
+        } else if (held && is_last(held_word)) {
+            if (idle_cycles == Timeout) {
+                out.write(held_word); // flush on timeout
+                held = false;
+                packet_word_count = 0;
+            } else {
+                ++idle_cycles;
+            }
+        }
+    }
+};
+}} // Namespaces
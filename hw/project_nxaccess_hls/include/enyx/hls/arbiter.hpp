@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <ap_int.h>
 #include <hls_stream.h>
 
 #include "word_traits.hpp"
@@ -75,4 +77,173 @@ public:
         }
     }
 };
+
+/// Priority classes of the priority_arbiter inputs: class 0 is served first. single_priority_class
+/// puts every input in the same class, define a class with the same members to prioritize inputs.
+struct single_priority_class
+{
+    static const std::size_t class_count = 1;
+
+    static std::size_t
+    priority_class(std::size_t)
+    {
+        #pragma HLS INLINE
+        return 0;
+    }
+};
+
+/// Same as arbiter, but a packet of the inputs of a priority class is only started when no input
+/// of a higher priority class (see Classes::priority_class()) has one pending. The inputs of a
+/// class are served in round robin. A packet being forwarded is never interrupted.
+template<typename Id,
+         std::size_t BusCount,
+         typename Word,
+         typename Classes = single_priority_class>
+class priority_arbiter
+{
+public:
+    typedef Word data_in_word;
+    typedef Word data_out_word;
+    static const std::size_t bus_count = BusCount;
+    static const std::size_t class_count = Classes::class_count;
+
+public:
+    static void
+    p_arbitrate(hls::stream<data_in_word> (&in)[bus_count],
+                hls::stream<data_out_word> & out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        static std::size_t last_used_bus_ids[class_count]; /// last input served, per class
+        #pragma HLS ARRAY_PARTITION variable=last_used_bus_ids complete dim=1
+        #pragma HLS RESET variable=last_used_bus_ids
+        static std::size_t forwarded_bus_id; /// input of the packet being forwarded
+        #pragma HLS RESET variable=forwarded_bus_id
+        static enum { IDLE, FORWARDING } state;
+        #pragma HLS RESET variable=state
+
+        switch (state)
+        {
+        case IDLE: {
+            // the first pending input of the highest priority class, from its last used input
+            bool found = false;
+            std::size_t selected = 0;
+            for (std::size_t class_id = 0; class_id != class_count; ++class_id)
+            {
+                for (std::size_t i = 1; i <= bus_count; ++i)
+                {
+                    std::size_t bus_id = last_used_bus_ids[class_id] + i;
+                    if (bus_id >= bus_count)
+                        bus_id -= bus_count;
+
+                    if (! found && Classes::priority_class(bus_id) == class_id && ! in[bus_id].empty())
+                    {
+                        found = true;
+                        selected = bus_id;
+                    }
+                }
+            }
+
+            if (found)
+            {
+                data_in_word word_in;
+                for (std::size_t bus_id = 0; bus_id != bus_count; ++bus_id)
+                    if (bus_id == selected)
+                        word_in = in[bus_id].read();
+                for (std::size_t class_id = 0; class_id != class_count; ++class_id)
+                    if (class_id == Classes::priority_class(selected))
+                        last_used_bus_ids[class_id] = selected;
+                forwarded_bus_id = selected;
+
+                out.write(word_in);
+                if (! is_last(word_in))
+                    state = FORWARDING;
+            }
+            break;
+        }
+
+        case FORWARDING:
+            if (! in[forwarded_bus_id].empty())
+            {
+                data_in_word const word_in = in[forwarded_bus_id].read();
+                out.write(word_in);
+                if (is_last(word_in))
+                    state = IDLE;
+            }
+            break;
+        }
+    }
+};
+
+/// Same as arbiter, for a large number of inputs: the input served is chosen in the cycle before
+/// it is read, by a one-hot priority encoder (lowest pending input above the last served one,
+/// a carry chain) rather than a scan of the inputs from the last served one. The output gets a
+/// cycle of latency, and keeps one word per cycle, packets of different inputs included.
+/// An input keeps the grant after its packet when no other input has one pending: a single busy
+/// input gets a word per cycle, its next packet being read as soon as its FIFO has it.
+template<typename Id,
+         std::size_t BusCount,
+         typename Word>
+class onehot_arbiter
+{
+public:
+    typedef Word data_in_word;
+    typedef Word data_out_word;
+    static const std::size_t bus_count = BusCount;
+    typedef ap_uint<bus_count> bus_set;
+
+public:
+    static void
+    p_arbitrate(hls::stream<data_in_word> (&in)[bus_count],
+                hls::stream<data_out_word> & out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        static bus_set grant = 0; /// input read, one-hot, until the end of its packet
+        #pragma HLS RESET variable=grant
+        static bool parked = false; /// the granted input is between two packets
+        #pragma HLS RESET variable=parked
+
+        bus_set pending = 0;
+        for (std::size_t i = 0; i != bus_count; ++i)
+            if (! in[i].empty())
+                pending.set(i);
+
+        bool const granted_pending = (pending & grant) != 0;
+        bool packet_end = false;
+        if (granted_pending)
+        {
+            data_in_word word_in;
+            for (std::size_t i = 0; i != bus_count; ++i)
+                if (grant[i])
+                    word_in = in[i].read();
+            out.write(word_in);
+            packet_end = is_last(word_in);
+            parked = false;
+        }
+
+        if (grant == 0 || packet_end || (parked && ! granted_pending))
+        {
+            bus_set const candidates = packet_end ? bus_set(pending & ~grant) : pending;
+            bus_set const above_last = ~bus_set((grant << 1) - 1); /// none when the last one was the last input
+            bus_set const round = candidates & above_last;
+            bus_set const next = round != 0 ? lowest(round) : lowest(candidates);
+            if (next != 0) {
+                grant = next;
+                parked = false;
+            } else if (grant != 0) {
+                parked = true; // no other input is pending
+            }
+        }
+    }
+
+private:
+    /// lowest set bit of a set, one-hot
+    static bus_set
+    lowest(bus_set const& set)
+    {
+        #pragma HLS INLINE
+        return set & bus_set(~set + 1);
+    }
+};
 }} // Namespaces
\ No newline at end of file
@@ -0,0 +1,28 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <ap_int.h>
+
+namespace enyx {
+namespace hls_tools {
+
+/// Cycle count of the core clock, the time base of the timestamps of the core.
+/// The dataflow processes can't share a register: the count is kept by a free-running counter
+/// out of the core, and fed to the top level on an ap_none port, sampled by every stamping
+/// process. All the processes see the same count in a given cycle, whether they are stalled or
+/// not: the timestamps of different processes compare.
+typedef ap_uint<32> cycle_count;
+
+}} // Namespaces
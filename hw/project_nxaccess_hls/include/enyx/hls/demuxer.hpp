@@ -13,6 +13,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <ap_int.h>
 #include <hls_stream.h>
 
 namespace enyx {
@@ -42,5 +43,116 @@ class demuxer {
         }
 
     }
+
+    /// Same as above, also reporting on full_out the outputs which are full, in the cycles
+    /// an input word waits for them: an output holding a word its consumer didn't read yet is
+    /// not reported while the input is empty. The input is only read when no output is full,
+    /// so that the process keeps running, and reporting, while the outputs are full.
+    static void
+    p_demux(hls::stream<data_in_word> &in,
+          hls::stream<data_out_word> (&out)[bus_count],
+          hls::stream<ap_uint<bus_count> > &full_out) {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        ap_uint<bus_count> full = 0;
+        for(int i = 0; i != bus_count; ++i) {
+            if (out[i].full())
+                full.set(i);
+        }
+
+        if(!in.empty()) {
+            if (full != 0) {
+                full_out.write_nb(full);
+            } else {
+                Word const _read = in.read();
+                for(int i = 0; i != bus_count; ++i) {
+                    out[i].write(_read);
+                }
+            }
+        }
+    }
+};
+
+/// command_demuxer filter forwarding every command to every output
+struct accept_all_commands
+{
+    template<typename Opcode>
+    static bool
+    accepts(std::size_t, Opcode const&)
+    {
+        #pragma HLS INLINE
+        return true;
+    }
+};
+
+/// Demux the commands of an input stream to N children streams, each output only receiving the
+/// commands it accepts (Filter::accepts(output, opcode)). A command is made of the words up to
+/// Traits::is_command_end(), its opcode being Traits::opcode() of its first word: the command
+/// boundaries are decoded once for all the outputs.
+/// A word is written in the cycle it's read, unless one of its outputs is full: it's then held,
+/// and the full outputs it waits for are reported on full_out each cycle, until they all have
+/// room. The outputs filtering a command out never delay it.
+template<typename Id,
+         std::size_t BusCount,
+         typename Word,
+         typename Filter,
+         typename Traits>
+class command_demuxer {
+ public:
+    typedef Word data_in_word;
+    typedef Word data_out_word;
+    static const std::size_t bus_count = BusCount;
+    typedef ap_uint<bus_count> bus_set;
+
+    static void
+    p_demux(hls::stream<data_in_word> &in,
+          hls::stream<data_out_word> (&out)[bus_count],
+          hls::stream<bus_set> &full_out) {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        static bool start_of_command = true;
+        #pragma HLS RESET variable=start_of_command
+        static bus_set command_outputs; /// outputs of the command being forwarded
+        static Word held_word; /// word waiting for a full output
+        static bool held = false;
+        #pragma HLS RESET variable=held
+
+        bus_set full = 0;
+        for(int i = 0; i != bus_count; ++i) {
+            if (out[i].full())
+                full.set(i);
+        }
+
+        bool valid = held;
+        Word word = held_word;
+        if (! held && ! in.empty()) {
+            word = in.read();
+            valid = true;
+            if (start_of_command) {
+                bus_set outputs = 0;
+                for(int i = 0; i != bus_count; ++i) {
+                    if (Filter::accepts(i, Traits::opcode(word)))
+                        outputs.set(i);
+                }
+                command_outputs = outputs;
+            }
+            start_of_command = Traits::is_command_end(word);
+        }
+
+        if (valid) {
+            bus_set const blocking = full & command_outputs;
+            if (blocking != 0) {
+                full_out.write_nb(blocking);
+                held_word = word;
+                held = true;
+            } else {
+                for(int i = 0; i != bus_count; ++i) {
+                    if (command_outputs[i])
+                        out[i].write(word);
+                }
+                held = false;
+            }
+        }
+    }
 };
 }} // Namespaces
\ No newline at end of file
@@ -225,6 +225,15 @@ struct pow10_t<0>
     static std::size_t const value = 1;
 };
 
+/// Read latency of the URAM memories, in cycles: their RESOURCE pragmas set latency=2 to match.
+static std::size_t const uram_read_latency = 2;
+
+/// A URAM read-modify-write pipelined at II=1 updates the data on the cycle it comes back and
+/// writes it on the next one: when a read is issued, the writes of the uram_forward_depth previous
+/// iterations are not in the memory yet. They are forwarded to the reads, the inter-iteration
+/// dependence on the memory being then declared false.
+static std::size_t const uram_forward_depth = uram_read_latency + 1;
+
 template<int _AP_W, int _AP_I, ap_q_mode _AP_Q, ap_o_mode _AP_O, int _AP_N>
 inline ap_fixed<_AP_W, _AP_I, _AP_Q, _AP_O, _AP_N>
 ceil(ap_fixed<_AP_W, _AP_I, _AP_Q, _AP_O, _AP_N> x)
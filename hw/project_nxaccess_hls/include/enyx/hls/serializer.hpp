@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+namespace enyx {
+namespace hls_tools {
+
+/// Default payload traits: the payload holds its words in 'words', and their count in 'word_count'
+template<typename Payload>
+struct payload_traits
+{
+    typedef typename Payload::word_type word_type;
+    static std::size_t const max_word_count = Payload::max_word_count;
+
+    static std::size_t
+    word_count(Payload const& payload)
+    {
+        #pragma HLS INLINE
+        return payload.word_count;
+    }
+
+    static word_type const&
+    word(Payload const& payload, std::size_t index)
+    {
+        #pragma HLS INLINE
+        return payload.words[index];
+    }
+};
+
+/// Arbitration of the serializer sources: a source sends up to weight() payloads in a row when
+/// the other sources have some to send. round_robin gives the same weight to every source,
+/// define a class with the same weight() function for weighted round robin.
+struct round_robin
+{
+    static unsigned int
+    weight(std::size_t)
+    {
+        #pragma HLS INLINE
+        return 1;
+    }
+};
+
+/// Serializes multi-words payloads from SourceCount sources into a single words stream.
+/// The first word of a payload is written in the cycle it is dequeued, and the next payload
+/// is dequeued in the cycle following its last word: the output has no idle cycle as long as
+/// some payloads are pending. The sources are served in (weighted) round robin.
+template<typename Id,
+         std::size_t SourceCount,
+         typename Payload,
+         typename Arbitration = round_robin,
+         typename Traits = payload_traits<Payload> >
+class serializer
+{
+public:
+    typedef Payload data_in_payload;
+    typedef typename Traits::word_type data_out_word;
+    static const std::size_t source_count = SourceCount;
+
+public:
+    static void
+    p_serialize(hls::stream<data_in_payload> (&in)[source_count],
+                hls::stream<data_out_word> & out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+        static std::size_t last_used_source;
+        #pragma HLS RESET variable=last_used_source
+        static ap_uint<8> credits; /// payloads the last used source may still send in a row
+        #pragma HLS RESET variable=credits
+
+        static data_out_word current_words[Traits::max_word_count]; /// payload being written
+        #pragma HLS ARRAY_PARTITION variable=current_words complete dim=1
+        static std::size_t word_index; /// next word of the payload to write
+        static std::size_t words_left = 0; /// words of the payload not written yet
+        #pragma HLS RESET variable=words_left
+
+        if (words_left != 0) {
+            out.write(current_words[word_index]);
+            ++word_index;
+            --words_left;
+        } else {
+            // the last used source has the highest priority while it has credits, the lowest otherwise
+            bool found = false;
+            std::size_t selected = 0;
+            for (std::size_t i = 1; i <= source_count; ++i) {
+                std::size_t source_id = last_used_source + i;
+                if (source_id >= source_count)
+                    source_id -= source_count;
+
+                if (! found && ! in[source_id].empty()) {
+                    found = true;
+                    selected = source_id;
+                }
+            }
+            bool const keep = credits != 0 && ! in[last_used_source].empty();
+            if (keep)
+                selected = last_used_source;
+
+            if (found) {
+                data_in_payload payload;
+                for (std::size_t source_id = 0; source_id != source_count; ++source_id)
+                    if (source_id == selected)
+                        payload = in[source_id].read();
+
+                credits = keep ? ap_uint<8>(credits - 1) : ap_uint<8>(Arbitration::weight(selected) - 1);
+                last_used_source = selected;
+
+                for (std::size_t i = 0; i != Traits::max_word_count; ++i)
+                    current_words[i] = Traits::word(payload, i);
+
+                // the first word is written right away
+                out.write(Traits::word(payload, 0));
+                word_index = 1;
+                words_left = Traits::word_count(payload) - 1;
+            }
+        }
+    }
+};
+}} // Namespaces
@@ -0,0 +1,70 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+
+namespace enyx {
+namespace hls_tools {
+
+/// End of a typelist
+struct null_type {};
+
+/// Compile-time list of types: typelist<A, typelist<B, typelist<C> > >
+template<typename Head, typename Tail = null_type>
+struct typelist
+{
+    typedef Head head;
+    typedef Tail tail;
+};
+
+/// Number of types in a typelist
+template<typename List>
+struct length
+{
+    static const std::size_t value = 1 + length<typename List::tail>::value;
+};
+
+template<>
+struct length<null_type>
+{
+    static const std::size_t value = 0;
+};
+
+/// Position of a type in a typelist (compilation fails if the type is not in the list)
+template<typename List, typename Type>
+struct index_of
+{
+    static const std::size_t value = 1 + index_of<typename List::tail, Type>::value;
+};
+
+template<typename Type, typename Tail>
+struct index_of<typelist<Type, Tail>, Type>
+{
+    static const std::size_t value = 0;
+};
+
+/// Type at a position of a typelist
+template<typename List, std::size_t Index>
+struct type_at
+{
+    typedef typename type_at<typename List::tail, Index - 1>::type type;
+};
+
+template<typename List>
+struct type_at<List, 0>
+{
+    typedef typename List::head type;
+};
+
+}} // Namespaces
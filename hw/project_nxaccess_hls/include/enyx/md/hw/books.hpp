@@ -17,99 +17,209 @@
 
 #include <stdint.h>
 
+#include "../../hls/helpers.hpp"
 #include "nxbus.hpp"
 namespace enyx {
 namespace md {
 namespace hw {
 
-/// Container class/core for storing books top level data
-template <unsigned int ClientCount = 2, unsigned int InstrumentCount = 256>
+/// Container class/core for storing books data, Depth price levels per side.
+/// TrackedDepth >= Depth price levels per side are tracked to apply the updates, so that the levels
+/// vacated by a deletion are refilled from the deeper ones, only the Depth top levels being read
+/// by the clients. The prices beyond TrackedDepth are lost: a half book may show less levels than
+/// the market once more than TrackedDepth - Depth of its levels were deleted.
+/// Without ClientReads, the clients don't read the books memory but a memory caching the top
+/// of book, fed by the top levels changes: the per client replicas are left out.
+template <unsigned int ClientCount = 2, unsigned int InstrumentCount = 256, unsigned int Depth = 1, unsigned int TrackedDepth = Depth,
+          bool ClientReads = true>
 class BooksData
 {
   public:
     static std::size_t const instrument_count = InstrumentCount;
+    static std::size_t const depth = Depth;
+    static std::size_t const tracked_depth = TrackedDepth;
+    /// book of the instruments without slot (see InstrumentMap::UnknownSlot), never updated
+    static std::size_t const unknown_book_index = 0;
+    static std::size_t const order_count_width = 16;
 
     // read book request
     typedef uint32_t read_book_data_request ; /// read book data request in memory
 
+    /// book update actions, applied on one half book
+    enum update_actions {
+        SetLevel = 0,        /// overwrite level 'level' (BOOK_UPDATE, LIMIT_CHANGE)
+        PriceDelta = 1,      /// remove quantities at 'removed_price', then add quantities at 'price'
+                             /// levels are kept sorted, a level is deleted when its quantity reaches 0
+                             /// (order level commands, PRICE_ADD_QTY, PRICE_REDUCE_QTY)
+        InsertLevel = 2,     /// insert a level at 'level', the next levels move down (LIMIT_ADD)
+        DeleteLevel = 3,     /// delete level 'level', the next levels move up (LIMIT_DEL)
+        DeleteFromLevel = 4, /// delete the levels 'level' and above (LIMIT_DEL_SUP_EQUAL)
+        DeleteToLevel = 5,   /// delete the levels up to 'level', the next levels move up (LIMIT_DEL_INF_EQUAL)
+        SetPrice = 6,        /// set the quantities at 'price', a level is deleted when its quantity is 0
+                             /// (PRICE_UPDATE, PRICE_MANAGED_UPDATE)
+    };
+
     // update book request
     struct halfbook_entry_update_request {
         ap_uint<32> book_index;
         ap_uint<1> side; //buy_nsell:  buy = 1, sell = 0
-        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> toplevel_price;
+        ap_uint<4> action; // see update_actions
+        ap_uint<8> level; // price level in the half book, 0 is top level
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> price;
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> qty; // total (or added) quantity at this price level
+        ap_uint<order_count_width> order_count; // orders count (or added orders) at this price level, 0 if not provided by the feed
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> removed_price; // PriceDelta only
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> removed_qty; // PriceDelta only
+        ap_uint<order_count_width> removed_order_count; // PriceDelta only
         ap_uint<8> uncross_depth; // uncross depth information from the PBU feature
     };
 
-    /// memory structure used for storing instrument configuration
-    /// layout of the packet sent by software to FPGA
-    /// see messages.hpp for message layout reference
+    /// memory structure used for storing one price level of a half book
     struct halfbook_entry {
         //constructors
-        halfbook_entry(ap_uint<1> _present, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> _price):
-               present(_present), toplevel_price(_price) {}
+        halfbook_entry(ap_uint<1> _present, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> _price,
+                       ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> _qty, ap_uint<order_count_width> _order_count):
+               present(_present), price(_price), qty(_qty), order_count(_order_count) {}
         halfbook_entry() {}
         //data
         ap_uint<1> present;
-        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> toplevel_price;
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> price;
+        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> qty;
+        ap_uint<order_count_width> order_count;
     };
 
+    /// Full depth book, index 0 is the top level of each side
     struct book_entry {
         //constructors
         book_entry() {}
-        book_entry( ap_uint<1> _ask_present, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> _ask_toplevel_price,
-                    ap_uint<1> _bid_present, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> _bid_toplevel_price):
-            ask_present(_ask_present), ask_toplevel_price(_ask_toplevel_price),
-            bid_present(_bid_present), bid_toplevel_price(_bid_toplevel_price) {}
         //data
-        ap_uint<1> ask_present;
-        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> ask_toplevel_price;
-        ap_uint<1> bid_present;
-        ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> bid_toplevel_price;
+        halfbook_entry ask[Depth];
+        halfbook_entry bid[Depth];
+    };
+
+    /// top level of a half book, sent when it changes
+    struct top_of_book_update {
+        ap_uint<32> book_index;
+        ap_uint<1> side; //buy_nsell:  buy = 1, sell = 0
+        halfbook_entry top;
     };
 
     BooksData() {}
 
 public: // public data
 
-    /// Read book request from other functions and answer to it
+    /// Read book request from other functions and answer to it, apply book updates.
+    /// The books memory is replicated once per client, plus a master copy of the tracked levels
+    /// read to apply the updates, so that an update and all the clients reads are served on the same cycle.
+    /// The half books written on the last cycles are forwarded to the reads hitting them.
+    /// All the levels are returned at once. The changes of the top levels are also output,
+    /// for the memories caching the top of book. Without ClientReads, the read requests are ignored.
     static void
     p_book_requests(hls::stream<BooksData::halfbook_entry_update_request> & update_halfbook,
                                   hls::stream<BooksData::read_book_data_request> (& req_read_book_req_in)[ClientCount],
-                                  hls::stream<BooksData::book_entry> (& read_book_req_out)[ClientCount])
+                                  hls::stream<BooksData::book_entry> (& read_book_req_out)[ClientCount],
+                                  hls::stream<BooksData::top_of_book_update> & top_of_book_out)
     {
 
-        /// Stores books data : half[0][x] is Sell side, half[1][x] is Buy side
-        static halfbook_entry books_data[2][BooksData<ClientCount,InstrumentCount>::instrument_count];
-        // split in at least 2 memories, one for each side
-        #pragma HLS ARRAY_PARTITION variable=books_data block factor=2 dim=1
+        /// Stores books data, one replica per client :
+        /// [replica][0][level][x] is Sell side, [replica][1][level][x] is Buy side
+        static halfbook_entry books_data[ClientCount][2][Depth][instrument_count];
+        // one memory per replica, per side and per level, each one with its own ports
+        #pragma HLS ARRAY_PARTITION variable=books_data complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=books_data complete dim=2
+        #pragma HLS ARRAY_PARTITION variable=books_data complete dim=3
+        #pragma HLS RESOURCE variable=books_data core=XPM_MEMORY uram latency=2
+        // written after the update, the writes of the last cycles and of this one are forwarded
+        #pragma HLS DEPENDENCE variable=books_data inter false
+
+        /// Master copy, all the tracked levels: [0][level][x] is Sell side, [1][level][x] is Buy side
+        static halfbook_entry tracked_data[2][TrackedDepth][instrument_count];
+        #pragma HLS ARRAY_PARTITION variable=tracked_data complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=tracked_data complete dim=2
+        #pragma HLS RESOURCE variable=tracked_data core=XPM_MEMORY uram latency=2
+        // read-modify-write, the writes of the last cycles are forwarded
+        #pragma HLS DEPENDENCE variable=tracked_data inter false
+
+        /// half books written on the last cycles, most recent first
+        static halfbook_write recent_writes[forward_depth];
+        #pragma HLS ARRAY_PARTITION variable=recent_writes complete dim=0
 
         #pragma HLS INLINE recursive
         #pragma HLS PIPELINE enable_flush
+
+        bool update_valid = false;
+        halfbook_entry_update_request update = halfbook_entry_update_request();
         if(!update_halfbook.empty()) { // incoming request for update
-            // get update request data : book index, price & side
-            halfbook_entry_update_request const request = update_halfbook.read();
-            // update memory with halfbook
-            books_data[request.side][request.book_index] = halfbook_entry(1, request.toplevel_price);
-            return;
+            update = update_halfbook.read();
+            update_valid = true;
+        }
+
+        // read, forward & update the master copy of the half book
+        halfbook_write current_write;
+        current_write.valid = update_valid;
+        current_write.book_index = update.book_index;
+        current_write.side = update.side;
+        for (int level = 0; level != TrackedDepth; ++level)
+            current_write.levels[level] = tracked_data[update.side][level][update.book_index];
+        forward(recent_writes, current_write.levels, update.book_index, update.side);
+        halfbook_entry const previous_top = current_write.levels[0];
+        apply_update(current_write.levels, update);
+
+        halfbook_entry const& top = current_write.levels[0];
+        if (update_valid && (top.present != previous_top.present || top.price != previous_top.price ||
+                             top.qty != previous_top.qty || top.order_count != previous_top.order_count)) {
+            top_of_book_update top_update;
+            top_update.book_index = update.book_index;
+            top_update.side = update.side;
+            top_update.top = top;
+            top_of_book_out.write(top_update);
         }
 
-         // process first the memory resquest for min latency
         for (int i = 0; i != ClientCount ; ++ i) {
-            if(!req_read_book_req_in[i].empty()) { // if we got some input, read memory & output
+            if(ClientReads && !req_read_book_req_in[i].empty()) { // if we got some input, read memory & output
                 //read request
                 read_book_data_request const book_index_req = req_read_book_req_in[i].read();
-                //read data from memory, latency is here. Both memories are splitted
-                halfbook_entry const sell = books_data[0][book_index_req];
-                halfbook_entry const buy  = books_data[1][book_index_req];
-                // prepare output
-                book_entry output = book_entry(sell.present, sell.toplevel_price,
-                                               buy.present, buy.toplevel_price);
+                book_entry output;
+                //read data from this client replica, latency is here. All levels are splitted
+                for (int level = 0; level != Depth; ++level) {
+                    output.ask[level] = books_data[i][0][level][book_index_req];
+                    output.bid[level] = books_data[i][1][level][book_index_req];
+                }
+                // forward the updates, including the one of this cycle
+                forward(recent_writes, output.ask, book_index_req, 0);
+                forward(recent_writes, output.bid, book_index_req, 1);
+                forward(current_write, output.ask, book_index_req, 0);
+                forward(current_write, output.bid, book_index_req, 1);
                 read_book_req_out[i].write(output);
-                // break; // we only process a book request at a time
             }
         }
+
+        for (int w = forward_depth - 1; w != 0; --w)
+            recent_writes[w] = recent_writes[w - 1];
+        recent_writes[0] = current_write;
+
+        // update every replica with the half book
+        if (update_valid) {
+            for (int level = 0; level != TrackedDepth; ++level)
+                tracked_data[update.side][level][update.book_index] = current_write.levels[level];
+            for (int i = 0; i != ClientCount; ++i)
+                for (int level = 0; level != Depth; ++level)
+                    if (ClientReads)
+                        books_data[i][update.side][level][update.book_index] = current_write.levels[level];
+        }
     } // p_book_requests
 
+    /// nxbus commands processed by p_book_updates(): the limit, price & book updates
+    static bool
+    accepts_nxbus_opcode(ap_uint<nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        return opcode(7, 4) == 0x4 || opcode(7, 4) == 0x5 || opcode == NXBUS_OPCODE_BOOK_UPDATE;
+    }
+
+    /// Book updates from nxbus. The book index is taken from the nxbus user field,
+    /// which holds the instrument slot (see InstrumentMap). The commands of the unknown
+    /// instruments are dropped, so that they don't share a book.
     static void
     p_book_updates(hls::stream<nxbus_axi> & nxbus_in,
                    hls::stream<BooksData::halfbook_entry_update_request> & book_update_request_out)
@@ -120,12 +230,12 @@ public: // public data
         static bool start_of_nxbus_command = true;
         #pragma HLS RESET variable=start_of_nxbus_command
 
-        static uint8_t current_opcode = 0x00; // opcode of the current nxbus command (in case of multi-cycle commands)
-        #pragma HLS RESET variable=current_opcode
-
-        static BooksData<2,256>::halfbook_entry_update_request output;
+        static halfbook_entry_update_request output;
         #pragma HLS RESET variable=output
 
+        static bool update_pending = false; // whether the current command is a book update to forward
+        #pragma HLS RESET variable=update_pending
+
         // Local variables
         nxbus_axi nxbus_data_in;
         //TODO check if these pragmas are really required.
@@ -137,19 +247,54 @@ public: // public data
             nxbus_data_in = nxbus_in.read();
             nxbus_word_in = static_cast<nxbus>(nxbus_data_in);
             if (start_of_nxbus_command) {
-                current_opcode = nxbus_word_in.opcode;
-                if ((nxbus_word_in.opcode == NXBUS_OPCODE_BOOK_UPDATE) &&
-                        (nxbus_word_in.data2(7,0) == 0)) { //only keep level 0 of buy or sell side
+                update_pending = true;
+                uint8_t action = SetLevel;
+                if (nxbus_word_in.opcode == NXBUS_OPCODE_BOOK_UPDATE || nxbus_word_in.opcode == NXBUS_OPCODE_LIMIT_CHANGE)
+                    update_pending = nxbus_word_in.data2(7,0) < TrackedDepth; // only keep the levels we track
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_LIMIT_ADD)
+                    action = InsertLevel;
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_LIMIT_DEL)
+                    action = DeleteLevel;
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_LIMIT_DEL_SUP_EQUAL)
+                    action = DeleteFromLevel;
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_LIMIT_DEL_INF_EQUAL)
+                    action = DeleteToLevel;
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_PRICE_UPDATE || nxbus_word_in.opcode == NXBUS_OPCODE_PRICE_MANAGED_UPDATE)
+                    action = SetPrice;
+                else if (nxbus_word_in.opcode == NXBUS_OPCODE_PRICE_ADD_QTY || nxbus_word_in.opcode == NXBUS_OPCODE_PRICE_REDUCE_QTY)
+                    action = PriceDelta;
+                else
+                    update_pending = false;
+
+                if (nxbus_data_in.user == unknown_book_index)
+                    update_pending = false;
+
+                if (update_pending) {
 
                     std::cout << "[DECISION][book_updater] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
                                 << "Updating book for instrument : " << nxbus_word_in.instr_id
+                                << " opcode=" << uint32_t(nxbus_word_in.opcode)
                                 << " price=" << nxbus_word_in.price
+                                << " qty=" << nxbus_word_in.qty
                                 << " side=" << nxbus_word_in.buy_nsell
+                                << " level=" << nxbus_word_in.data2(7,0)
                                 << std::endl;
-                    //BooksData<2,256>::halfbook_entry_update_request output = BooksData<2,256>::halfbook_entry_update_request();
-                    output.book_index = nxbus_word_in.instr_id;
+                    output.book_index = nxbus_data_in.user; // instrument slot
                     output.side = nxbus_word_in.buy_nsell;
-                    output.toplevel_price = nxbus_word_in.price;
+                    output.action = action;
+                    output.level = nxbus_word_in.data2(7,0);
+                    output.price = nxbus_word_in.price;
+                    output.qty = nxbus_word_in.qty;
+                    output.order_count = nxbus_word_in.data1(order_count_width-1, 0); // number of orders, when provided by the feed
+                    // PRICE_REDUCE_QTY removes quantity at the price, PRICE_ADD_QTY adds it
+                    bool const reduce = nxbus_word_in.opcode == NXBUS_OPCODE_PRICE_REDUCE_QTY;
+                    output.removed_price = nxbus_word_in.price;
+                    output.removed_qty = reduce ? nxbus_word_in.qty : ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY>(0);
+                    output.removed_order_count = reduce ? output.order_count : ap_uint<order_count_width>(0);
+                    if (reduce) {
+                        output.qty = 0;
+                        output.order_count = 0;
+                    }
                     output.uncross_depth = 0x00;
                     if (nxbus_word_in.end_of_extra) {
                         book_update_request_out.write(output);
@@ -163,7 +308,7 @@ public: // public data
                 nxbus_extra_data(128-1, 64) = nxbus_word_in.data0;
                 nxbus_extra_data(64-1, 0) = nxbus_word_in.data2;
 
-                if (current_opcode == NXBUS_OPCODE_BOOK_UPDATE) {
+                if (update_pending) {
                     // Capture the uncross depth value (HKEX specific)
                     output.uncross_depth = nxbus_extra_data(240-1, 232);
 
@@ -180,6 +325,217 @@ public: // public data
         }
     } // p_book_updates
 
+    /// Merges the book updates of two sources (price level & order level commands) into the
+    /// p_book_requests() input, one update per cycle. The sources are served alternately when
+    /// both have an update pending.
+    static void
+    p_merge_updates(hls::stream<BooksData::halfbook_entry_update_request> (& updates_in)[2],
+                    hls::stream<BooksData::halfbook_entry_update_request> & updates_out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+
+        static ap_uint<1> last_source = 1; // source of the last update forwarded
+        #pragma HLS RESET variable=last_source
+
+        bool const first_pending = ! updates_in[0].empty();
+        bool const second_pending = ! updates_in[1].empty();
+        if (first_pending && (! second_pending || last_source == 1)) {
+            updates_out.write(updates_in[0].read());
+            last_source = 0;
+        } else if (second_pending) {
+            updates_out.write(updates_in[1].read());
+            last_source = 1;
+        }
+    } // p_merge_updates
+
+private:
+    /// number of written half books kept for forwarding, the writes not in memory yet when a read is issued
+    static std::size_t const forward_depth = enyx::uram_forward_depth;
+
+    /// a half book written to memory
+    struct halfbook_write {
+        ap_uint<1> valid;
+        ap_uint<32> book_index;
+        ap_uint<1> side;
+        halfbook_entry levels[TrackedDepth];
+    };
+
+    /// replaces the LevelCount top levels of the half book read from memory by the write, if on it
+    template<unsigned int LevelCount>
+    static void
+    forward(halfbook_write const& write, halfbook_entry (& levels)[LevelCount],
+            ap_uint<32> const& book_index, ap_uint<1> const& side)
+    {
+        #pragma HLS INLINE
+        if (write.valid && write.book_index == book_index && write.side == side)
+            for (int level = 0; level != LevelCount; ++level)
+                levels[level] = write.levels[level];
+    }
+
+    /// replaces the LevelCount top levels of the half book read from memory by the most recent write on it
+    template<unsigned int LevelCount>
+    static void
+    forward(halfbook_write const (& recent_writes)[forward_depth], halfbook_entry (& levels)[LevelCount],
+            ap_uint<32> const& book_index, ap_uint<1> const& side)
+    {
+        #pragma HLS INLINE
+        for (int w = forward_depth - 1; w >= 0; --w) // oldest first
+            forward(recent_writes[w], levels, book_index, side);
+    }
+
+    /// true if price 'a' is better than price 'b' on this side
+    static bool
+    is_better(ap_uint<1> const& side, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> const& a,
+              ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> const& b)
+    {
+        #pragma HLS INLINE
+        return side == 1 ? a > b : a < b;
+    }
+
+    /// deletes a level, the next levels move up
+    static void
+    remove_level(halfbook_entry (& levels)[TrackedDepth], ap_uint<8> const& removed)
+    {
+        #pragma HLS INLINE
+        for (int level = 0; level != TrackedDepth; ++level)
+            if (level >= removed)
+                levels[level] = level + 1 != TrackedDepth ? levels[level + 1] : halfbook_entry(0, 0, 0, 0);
+    }
+
+    /// inserts a level, the next levels move down and the last one is lost
+    static void
+    insert_level(halfbook_entry (& levels)[TrackedDepth], ap_uint<8> const& inserted, halfbook_entry const& entry)
+    {
+        #pragma HLS INLINE
+        for (int level = TrackedDepth - 1; level >= 0; --level)
+            if (level > inserted)
+                levels[level] = levels[level - 1];
+            else if (level == inserted)
+                levels[level] = entry;
+    }
+
+    /// removes quantity and orders from the level at this price, deletes the level when empty
+    static void
+    reduce_price(halfbook_entry (& levels)[TrackedDepth], ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> const& price,
+                 ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> const& qty, ap_uint<order_count_width> const& order_count)
+    {
+        #pragma HLS INLINE
+        bool found = false;
+        ap_uint<8> found_level = 0;
+        for (int level = 0; level != TrackedDepth; ++level)
+            if (levels[level].present && levels[level].price == price) {
+                found = true;
+                found_level = level;
+            }
+        if (! found)
+            return;
+
+        halfbook_entry & entry = levels[found_level];
+        entry.qty = qty >= entry.qty ? ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY>(0) : ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY>(entry.qty - qty);
+        entry.order_count = order_count >= entry.order_count ? ap_uint<order_count_width>(0) : ap_uint<order_count_width>(entry.order_count - order_count);
+        if (entry.qty == 0)
+            remove_level(levels, found_level);
+    }
+
+    /// adds quantity and orders to the level at this price, inserts the level if missing
+    static void
+    add_price(halfbook_entry (& levels)[TrackedDepth], ap_uint<1> const& side, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> const& price,
+              ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> const& qty, ap_uint<order_count_width> const& order_count)
+    {
+        #pragma HLS INLINE
+        // levels are sorted, the position is the count of better levels
+        ap_uint<8> position = 0;
+        for (int level = 0; level != TrackedDepth; ++level)
+            if (levels[level].present && is_better(side, levels[level].price, price))
+                ++position;
+        if (position == TrackedDepth) // out of the tracked depth
+            return;
+
+        if (levels[position].present && levels[position].price == price) {
+            levels[position].qty += qty;
+            levels[position].order_count += order_count;
+        } else
+            insert_level(levels, position, halfbook_entry(1, price, qty, order_count));
+    }
+
+    /// deletes the levels from 'first' to 'last', the next levels move up
+    static void
+    remove_levels(halfbook_entry (& levels)[TrackedDepth], ap_uint<8> const& first, ap_uint<8> const& last)
+    {
+        #pragma HLS INLINE
+        ap_uint<9> const removed_count = ap_uint<9>(last) - first + 1;
+        for (int level = 0; level != TrackedDepth; ++level)
+            if (level >= first) {
+                ap_uint<9> const source = level + removed_count;
+                levels[level] = source < TrackedDepth ? levels[source] : halfbook_entry(0, 0, 0, 0);
+            }
+    }
+
+    /// sets the quantities of the level at this price: updated, inserted or deleted if the quantity is 0
+    static void
+    set_price(halfbook_entry (& levels)[TrackedDepth], ap_uint<1> const& side, ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> const& price,
+              ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> const& qty, ap_uint<order_count_width> const& order_count)
+    {
+        #pragma HLS INLINE
+        ap_uint<8> position = 0;
+        for (int level = 0; level != TrackedDepth; ++level)
+            if (levels[level].present && is_better(side, levels[level].price, price))
+                ++position;
+        if (position == TrackedDepth) // out of the tracked depth
+            return;
+
+        bool const exists = levels[position].present && levels[position].price == price;
+        if (qty == 0) {
+            if (exists)
+                remove_level(levels, position);
+        } else if (exists) {
+            levels[position].qty = qty;
+            levels[position].order_count = order_count;
+        } else
+            insert_level(levels, position, halfbook_entry(1, price, qty, order_count));
+    }
+
+    /// applies an update request on a half book
+    static void
+    apply_update(halfbook_entry (& levels)[TrackedDepth], halfbook_entry_update_request const& update)
+    {
+        #pragma HLS INLINE
+        switch (update.action) {
+        case SetLevel:
+            if (update.level < TrackedDepth)
+                levels[update.level] = halfbook_entry(1, update.price, update.qty, update.order_count);
+            break;
+        case PriceDelta:
+            if (update.removed_qty != 0 || update.removed_order_count != 0)
+                reduce_price(levels, update.removed_price, update.removed_qty, update.removed_order_count);
+            if (update.qty != 0)
+                add_price(levels, update.side, update.price, update.qty, update.order_count);
+            break;
+        case InsertLevel:
+            if (update.level < TrackedDepth)
+                insert_level(levels, update.level, halfbook_entry(1, update.price, update.qty, update.order_count));
+            break;
+        case DeleteLevel:
+            if (update.level < TrackedDepth)
+                remove_level(levels, update.level);
+            break;
+        case DeleteFromLevel:
+            for (int level = 0; level != TrackedDepth; ++level)
+                if (level >= update.level)
+                    levels[level] = halfbook_entry(0, 0, 0, 0);
+            break;
+        case DeleteToLevel:
+            remove_levels(levels, 0, update.level < TrackedDepth ? ap_uint<8>(update.level) : ap_uint<8>(TrackedDepth - 1));
+            break;
+        case SetPrice:
+            set_price(levels, update.side, update.price, update.qty, update.order_count);
+            break;
+        default:
+            break;
+        }
+    }
+
 }; // class BooksData
 }}} // Namespaces
 
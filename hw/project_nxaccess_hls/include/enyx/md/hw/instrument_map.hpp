@@ -0,0 +1,220 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+#include <iostream>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include <stdint.h>
+
+#include "../../hls/helpers.hpp"
+#include "nxbus.hpp"
+
+namespace enyx {
+namespace md {
+namespace hw {
+
+/// Maps the sparse nxbus instrument ids to dense slots, used as index by the instruments memories.
+/// The map is a Ways-way set associative table: the set is a hash of the instrument id, and
+/// all the ways of a set are compared in parallel, so that a lookup is done in a single cycle.
+/// Slot 0 (UnknownSlot) is reserved for the unknown instruments and is never allocated, so that
+/// Capacity - 1 instruments can be mapped: the consumers of the nxbus drop the updates of UnknownSlot.
+///
+/// The control plane (configuration) allocates slots with find_or_insert() and forwards the
+/// resulting map updates to the data plane replica owned by p_map_nxbus().
+template<typename Id, unsigned int Capacity = 4096, unsigned int Ways = 4>
+class InstrumentMap
+{
+  public:
+    static std::size_t const capacity = Capacity;
+    static std::size_t const ways = Ways;
+    /// twice as many entries as slots, to keep sets overflows unlikely
+    static std::size_t const set_count = 2 * Capacity / Ways;
+    static std::size_t const set_width = enyx::log2<set_count>::value;
+    static std::size_t const slot_width = enyx::log2<Capacity>::value;
+    static std::size_t const way_width = enyx::log2<Ways>::value + 1;
+
+    typedef ap_uint<nxbus_meta_sizes::NXBUS_SIZE_INSTR_ID> instrument_id;
+    typedef ap_uint<slot_width> slot;
+
+    enum { UnknownSlot = 0 }; /// slot of the instruments which are not mapped
+
+    /// one way of a set
+    struct map_entry {
+        ap_uint<1> valid;
+        instrument_id instr_id;
+        slot slot_index;
+    };
+
+    /// map update, sent by the control plane to the data plane replica
+    struct map_update {
+        instrument_id instr_id;
+        ap_uint<way_width> way;
+        slot slot_index;
+    };
+
+    InstrumentMap() {}
+
+    /// Folds the instrument id on the set index width
+    static ap_uint<set_width>
+    hash(instrument_id const& instr_id)
+    {
+        #pragma HLS INLINE
+        ap_uint<set_width> ret = 0;
+        for (std::size_t i = 0; i < nxbus_meta_sizes::NXBUS_SIZE_INSTR_ID; i += set_width)
+            ret ^= ap_uint<set_width>(instr_id >> i);
+        return ret;
+    }
+
+    /// Maps the instrument id of each nxbus command to its slot, written in the user field
+    /// of every word of the command. Unknown instruments get UnknownSlot.
+    static void
+    p_map_nxbus(hls::stream<nxbus_axi> & nxbus_in,
+                hls::stream<map_update> & map_updates_in,
+                hls::stream<nxbus_axi> & nxbus_out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+
+        static map_entry table[set_count][Ways];
+        // all the ways of a set are read at once
+        #pragma HLS ARRAY_PARTITION variable=table complete dim=2
+        #pragma HLS RESOURCE variable=table core=XPM_MEMORY uram latency=2
+        // the updates of the last cycles and of this one are forwarded to the lookups
+        #pragma HLS DEPENDENCE variable=table inter false
+
+        /// updates of the last cycles, most recent first
+        static map_update recent_updates[uram_forward_depth];
+        static ap_uint<1> recent_updates_valid[uram_forward_depth];
+        #pragma HLS ARRAY_PARTITION variable=recent_updates complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=recent_updates_valid complete dim=1
+        #pragma HLS RESET variable=recent_updates_valid
+
+        static bool start_of_nxbus_command = true;
+        #pragma HLS RESET variable=start_of_nxbus_command
+
+        static slot current_slot = UnknownSlot; // slot of the current nxbus command (in case of multi-cycle commands)
+        #pragma HLS RESET variable=current_slot
+
+        bool update_valid = false;
+        map_update update = map_update();
+        if (! map_updates_in.empty()) {
+            update = map_updates_in.read();
+            update_valid = true;
+        }
+
+        if (! nxbus_in.empty()) {
+            nxbus_axi nxbus_data_in = nxbus_in.read();
+            nxbus const nxbus_word_in = static_cast<nxbus>(nxbus_data_in);
+
+            if (start_of_nxbus_command) {
+                ap_uint<set_width> const set = hash(nxbus_word_in.instr_id);
+                current_slot = UnknownSlot;
+                for (unsigned int way = 0; way != Ways; ++way) {
+                    map_entry const entry = table[set][way];
+                    if (entry.valid && entry.instr_id == nxbus_word_in.instr_id)
+                        current_slot = entry.slot_index;
+                }
+                // forward the updates of the last cycles and of this one
+                for (int w = uram_forward_depth - 1; w >= 0; --w) // oldest first
+                    if (recent_updates_valid[w] && recent_updates[w].instr_id == nxbus_word_in.instr_id)
+                        current_slot = recent_updates[w].slot_index;
+                if (update_valid && update.instr_id == nxbus_word_in.instr_id)
+                    current_slot = update.slot_index;
+            }
+
+            nxbus_data_in.user = current_slot;
+            nxbus_out.write(nxbus_data_in);
+
+            start_of_nxbus_command = nxbus_word_in.end_of_extra; // end_of_extra is set on the last word of a given command
+        }
+
+        if (update_valid) {
+            map_entry entry;
+            entry.valid = 1;
+            entry.instr_id = update.instr_id;
+            entry.slot_index = update.slot_index;
+            table[hash(update.instr_id)][update.way] = entry;
+        }
+        for (int w = uram_forward_depth - 1; w != 0; --w) {
+            recent_updates[w] = recent_updates[w - 1];
+            recent_updates_valid[w] = recent_updates_valid[w - 1];
+        }
+        recent_updates[0] = update;
+        recent_updates_valid[0] = update_valid;
+    } // p_map_nxbus
+
+    /// Control plane lookup: gives the slot of an instrument, allocating a new slot if the
+    /// instrument is unknown. Returns false if the instrument can't be mapped (set or slots
+    /// exhausted). When a slot is allocated, 'inserted' is set and 'update' shall be sent
+    /// to the data plane replica.
+    static bool
+    find_or_insert(instrument_id const& instr_id, slot & slot_index, bool & inserted, map_update & update)
+    {
+        #pragma HLS INLINE
+
+        static map_entry table[set_count][Ways];
+        #pragma HLS ARRAY_PARTITION variable=table complete dim=2
+        #pragma HLS RESOURCE variable=table core=XPM_MEMORY uram
+
+        static ap_uint<slot_width + 1> next_free_slot = 1; // slot 0 is reserved
+        #pragma HLS RESET variable=next_free_slot
+
+        ap_uint<set_width> const set = hash(instr_id);
+
+        bool found = false;
+        bool free_way_found = false;
+        ap_uint<way_width> free_way = 0;
+        for (unsigned int way = 0; way != Ways; ++way) {
+            map_entry const entry = table[set][way];
+            if (entry.valid && entry.instr_id == instr_id) {
+                found = true;
+                slot_index = entry.slot_index;
+            }
+            if (! entry.valid && ! free_way_found) {
+                free_way_found = true;
+                free_way = way;
+            }
+        }
+
+        inserted = false;
+        if (found)
+            return true;
+
+        if (! free_way_found || next_free_slot == Capacity) {
+            std::cout << "[WARNING][instrument_map] Can't map instrument " << std::hex << instr_id
+                      << ", map is full" << std::endl;
+            return false;
+        }
+
+        slot_index = next_free_slot;
+        ++next_free_slot;
+
+        map_entry entry;
+        entry.valid = 1;
+        entry.instr_id = instr_id;
+        entry.slot_index = slot_index;
+        table[set][free_way] = entry;
+
+        update.instr_id = instr_id;
+        update.way = free_way;
+        update.slot_index = slot_index;
+        inserted = true;
+
+        std::cout << "[instrument_map] instrument " << std::hex << instr_id
+                  << " mapped to slot " << slot_index << std::endl;
+        return true;
+    } // find_or_insert
+
+}; // class InstrumentMap
+}}} // Namespaces
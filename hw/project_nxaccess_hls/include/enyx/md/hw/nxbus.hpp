@@ -145,6 +145,23 @@ struct nxbus {
 #undef ARG_TO_MEMBER
 #undef MEMBER_TO_ARG
 
+/// Commands of the nxbus words, for enyx::hls_tools::command_demuxer
+struct nxbus_command_traits {
+    typedef ap_uint<nxbus_meta_sizes::NXBUS_SIZE_OPCODE> opcode_type;
+
+    static opcode_type
+    opcode(nxbus_axi const& word) {
+        #pragma HLS INLINE
+        return static_cast<nxbus>(word).opcode;
+    }
+
+    static bool
+    is_command_end(nxbus_axi const& word) {
+        #pragma HLS INLINE
+        return static_cast<nxbus>(word).end_of_extra; // end_of_extra is set on the last word of a given command
+    }
+};
+
 // Instrument ID Constants
 static uint32_t NXBUS_NOT_FOUND_INSTRUMENT_INTERNAL_ID = 0x00000000;
 static uint32_t NXBUS_CMD_NOT_INSTRUMENT_INTERNAL_ID   = 0xFFFFFFFF;
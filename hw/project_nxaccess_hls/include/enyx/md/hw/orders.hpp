@@ -0,0 +1,300 @@
+//--------------------------------------------------------------------------------
+//--! Licensed Materials - Property of ENYX
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+#include <iostream>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include <stdint.h>
+
+#include "../../hls/helpers.hpp"
+#include "nxbus.hpp"
+
+namespace enyx {
+namespace md {
+namespace hw {
+
+/// Builds the books from the order level nxbus commands (ORDER_* and MANAGED_ORDER_*).
+/// Live orders are stored in a Ways-way set associative table keyed by order id, the set
+/// being a hash of the order id. All the ways of a set are compared in parallel, orders
+/// which don't fit in their set go to a small fully associative victim table, so that
+/// each command is handled in a single cycle whatever the collisions.
+/// Each command is turned into a PriceDelta update of the Books price levels.
+///
+/// ORDER_REPLACE is expected with the replaced order id in order_id and the new order id
+/// in data0: it takes two cycles, one per order id, the orders table having one read port.
+/// The nxbus input is not read during the second cycle: the commands after an ORDER_REPLACE
+/// wait one cycle, the only exception to one command per cycle.
+template<typename Books, unsigned int OrderCapacity = 65536, unsigned int Ways = 4, unsigned int VictimCount = 16>
+class OrderBook
+{
+  public:
+    static std::size_t const capacity = OrderCapacity;
+    static std::size_t const ways = Ways;
+    static std::size_t const victim_count = VictimCount;
+    static std::size_t const set_count = OrderCapacity / Ways;
+    static std::size_t const set_width = enyx::log2<set_count>::value;
+    static std::size_t const way_width = enyx::log2<Ways>::value + 1;
+    static std::size_t const victim_width = enyx::log2<VictimCount>::value + 1;
+    static std::size_t const slot_width = enyx::log2<Books::instrument_count>::value;
+
+    typedef ap_uint<nxbus_meta_sizes::NXBUS_SIZE_ORDER_ID> order_id;
+    typedef ap_uint<nxbus_meta_sizes::NXBUS_SIZE_PRICE> price_type;
+    typedef ap_uint<nxbus_meta_sizes::NXBUS_SIZE_QTY> qty_type;
+
+    /// a live order
+    struct order_entry {
+        ap_uint<1> valid;
+        order_id id;
+        ap_uint<slot_width> book_index; // instrument slot
+        ap_uint<1> side; //buy_nsell:  buy = 1, sell = 0
+        price_type price;
+        qty_type qty; // remaining quantity
+    };
+
+    OrderBook() {}
+
+    /// Folds the order id on the set index width
+    static ap_uint<set_width>
+    hash(order_id const& id)
+    {
+        #pragma HLS INLINE
+        ap_uint<set_width> ret = 0;
+        for (std::size_t i = 0; i < nxbus_meta_sizes::NXBUS_SIZE_ORDER_ID; i += set_width)
+            ret ^= ap_uint<set_width>(id >> i);
+        return ret;
+    }
+
+    /// nxbus commands processed by p_order_updates(): the order & managed order commands
+    static bool
+    accepts_nxbus_opcode(ap_uint<nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        return opcode(7, 4) == 0x2 || opcode(7, 4) == 0x3;
+    }
+
+    /// Order level nxbus commands processing, outputs the resulting book updates.
+    static void
+    p_order_updates(hls::stream<nxbus_axi> & nxbus_in,
+                    hls::stream<typename Books::halfbook_entry_update_request> & book_update_request_out)
+    {
+        #pragma HLS INLINE recursive
+        #pragma HLS PIPELINE enable_flush
+
+        static order_entry orders[set_count][Ways];
+        // all the ways of a set are read at once
+        #pragma HLS ARRAY_PARTITION variable=orders complete dim=2
+        #pragma HLS RESOURCE variable=orders core=XPM_MEMORY uram latency=2
+        // read-modify-write, the writes of the last cycles are forwarded
+        #pragma HLS DEPENDENCE variable=orders inter false
+
+        static order_entry victims[VictimCount];
+        #pragma HLS ARRAY_PARTITION variable=victims complete dim=1
+
+        /// orders table writes of the last cycles, most recent first
+        static order_write recent_writes[forward_depth];
+        #pragma HLS ARRAY_PARTITION variable=recent_writes complete dim=0
+
+        static bool start_of_nxbus_command = true;
+        #pragma HLS RESET variable=start_of_nxbus_command
+
+        /// second half of an ORDER_REPLACE: the new order to add
+        static bool pending_add = false;
+        #pragma HLS RESET variable=pending_add
+        static order_entry pending_order;
+
+        // decode the command of this cycle
+        bool command_valid = false;
+        uint8_t command = 0; // ORDER_* opcode
+        order_entry input = order_entry();
+        order_id replacing_id = 0;
+
+        if (pending_add) {
+            command_valid = true;
+            command = NXBUS_OPCODE_ORDER_ADD;
+            input = pending_order;
+            pending_add = false;
+        } else if (! nxbus_in.empty()) {
+            nxbus_axi const nxbus_data_in = nxbus_in.read();
+            nxbus const nxbus_word_in = static_cast<nxbus>(nxbus_data_in);
+
+            if (start_of_nxbus_command &&
+                nxbus_word_in.opcode >= NXBUS_OPCODE_ORDER_ADD && nxbus_word_in.opcode <= NXBUS_OPCODE_MANAGED_ORDER_MODIFY_QTY &&
+                nxbus_word_in.opcode(3, 0) >= 0x1 && nxbus_word_in.opcode(3, 0) <= 0xA) {
+                command_valid = true;
+                command = 0x20 | nxbus_word_in.opcode(3, 0); // managed orders are handled as orders
+                input.id = nxbus_word_in.order_id;
+                input.book_index = nxbus_data_in.user; // instrument slot
+                input.side = nxbus_word_in.buy_nsell;
+                input.price = nxbus_word_in.price;
+                input.qty = nxbus_word_in.qty;
+                replacing_id = nxbus_word_in.data0;
+
+                // orders of unknown instruments are not tracked
+                if (command == NXBUS_OPCODE_ORDER_ADD && input.book_index == Books::unknown_book_index)
+                    command_valid = false;
+            }
+            start_of_nxbus_command = nxbus_word_in.end_of_extra; // end_of_extra is set on the last word of a given command
+        }
+
+        // lookup the order in its set and in the victims
+        ap_uint<set_width> const set = hash(input.id);
+        order_entry set_entries[Ways];
+        #pragma HLS ARRAY_PARTITION variable=set_entries complete dim=1
+        for (int way = 0; way != Ways; ++way)
+            set_entries[way] = orders[set][way];
+        for (int w = forward_depth - 1; w >= 0; --w) // oldest first
+            if (recent_writes[w].valid && recent_writes[w].set == set)
+                set_entries[recent_writes[w].way] = recent_writes[w].entry;
+
+        bool found = false;
+        bool found_in_victims = false;
+        ap_uint<way_width> found_way = 0;
+        ap_uint<victim_width> found_victim = 0;
+        bool free_way_found = false;
+        ap_uint<way_width> free_way = 0;
+        for (int way = 0; way != Ways; ++way) {
+            if (set_entries[way].valid && set_entries[way].id == input.id) {
+                found = true;
+                found_way = way;
+            }
+            if (! set_entries[way].valid && ! free_way_found) {
+                free_way_found = true;
+                free_way = way;
+            }
+        }
+        bool free_victim_found = false;
+        ap_uint<victim_width> free_victim = 0;
+        for (int v = 0; v != VictimCount; ++v) {
+            if (victims[v].valid && victims[v].id == input.id) {
+                found = true;
+                found_in_victims = true;
+                found_victim = v;
+            }
+            if (! victims[v].valid && ! free_victim_found) {
+                free_victim_found = true;
+                free_victim = v;
+            }
+        }
+        order_entry const current = found_in_victims ? victims[found_victim] : set_entries[found_way];
+
+        // apply the command on the order
+        bool write_order = false;
+        order_entry updated = current;
+        typename Books::halfbook_entry_update_request update = typename Books::halfbook_entry_update_request();
+        update.action = Books::PriceDelta;
+        update.book_index = current.book_index;
+        update.side = current.side;
+        update.price = current.price;
+
+        if (command_valid && command == NXBUS_OPCODE_ORDER_ADD) {
+            if (found) {
+                std::cout << "[WARNING][order_book] order " << std::hex << input.id << " already exists" << std::endl;
+            } else if (! free_way_found && ! free_victim_found) {
+                std::cout << "[WARNING][order_book] order " << std::hex << input.id << " dropped, table is full" << std::endl;
+            } else {
+                updated = input;
+                updated.valid = 1;
+                write_order = true;
+                found_in_victims = ! free_way_found;
+                found_way = free_way;
+                found_victim = free_victim;
+
+                update.book_index = input.book_index;
+                update.side = input.side;
+                update.price = input.price;
+                update.qty = input.qty;
+                update.order_count = 1;
+            }
+        } else if (command_valid && ! found) {
+            std::cout << "[WARNING][order_book] order " << std::hex << input.id << " unknown" << std::endl;
+        } else if (command_valid) {
+            write_order = true;
+            price_type new_price = current.price;
+            qty_type new_qty = 0; // ORDER_DEL, ORDER_REPLACE
+
+            if (command == NXBUS_OPCODE_ORDER_EXEC || command == NXBUS_OPCODE_ORDER_EXEC_PRICE ||
+                command == NXBUS_OPCODE_ORDER_EXEC_PRICE_QTY || command == NXBUS_OPCODE_ORDER_REDUCE) {
+                new_qty = input.qty < current.qty ? qty_type(current.qty - input.qty) : qty_type(0);
+            } else if (command == NXBUS_OPCODE_ORDER_MODIFY) {
+                new_price = input.price;
+                new_qty = input.qty;
+            } else if (command == NXBUS_OPCODE_ORDER_MODIFY_PRICE) {
+                new_price = input.price;
+                new_qty = current.qty;
+            } else if (command == NXBUS_OPCODE_ORDER_MODIFY_QTY) {
+                new_qty = input.qty;
+            }
+
+            // the order is moved (or deleted) when its price changes, otherwise only the quantity delta is applied
+            update.removed_price = current.price;
+            update.price = new_price;
+            if (new_price != current.price || new_qty == 0) {
+                update.removed_qty = current.qty;
+                update.removed_order_count = 1;
+                update.qty = new_qty;
+                update.order_count = new_qty != 0;
+            } else if (new_qty < current.qty) {
+                update.removed_qty = current.qty - new_qty;
+            } else {
+                update.qty = new_qty - current.qty;
+            }
+
+            updated.valid = new_qty != 0;
+            updated.price = new_price;
+            updated.qty = new_qty;
+
+            if (command == NXBUS_OPCODE_ORDER_REPLACE) {
+                pending_add = true;
+                pending_order = current;
+                pending_order.id = replacing_id;
+                pending_order.price = input.price;
+                pending_order.qty = input.qty;
+            }
+        }
+
+        if (write_order)
+            book_update_request_out.write(update);
+
+        // write back the order
+        order_write current_write;
+        current_write.valid = write_order && ! found_in_victims;
+        current_write.set = set;
+        current_write.way = found_way;
+        current_write.entry = updated;
+        for (int w = forward_depth - 1; w != 0; --w)
+            recent_writes[w] = recent_writes[w - 1];
+        recent_writes[0] = current_write;
+
+        if (write_order) {
+            if (found_in_victims)
+                victims[found_victim] = updated;
+            else
+                orders[set][found_way] = updated;
+        }
+    } // p_order_updates
+
+  private:
+    /// number of orders table writes kept for forwarding, the writes not in memory yet when a read is issued
+    static std::size_t const forward_depth = enyx::uram_forward_depth;
+
+    /// an orders table write
+    struct order_write {
+        ap_uint<1> valid;
+        ap_uint<set_width> set;
+        ap_uint<way_width> way;
+        order_entry entry;
+    };
+
+}; // class OrderBook
+}}} // Namespaces
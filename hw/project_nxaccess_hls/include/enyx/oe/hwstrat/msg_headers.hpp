@@ -67,7 +67,7 @@ struct fpga2cpu_header {
     uint8_t reserved:3;     /// ack
 
     // third byte
-    uint32_t timestamp;   /// future use : hw timestamp, unused for now.
+    uint32_t timestamp;   /// hw timestamp: cycle at which the message was emitted
     uint16_t length;    /// message format version
 };
 
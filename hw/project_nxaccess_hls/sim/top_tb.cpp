@@ -45,9 +45,11 @@ public:
     static std::size_t const CYCLES_PER_MSG = 80;
 
 private:
+    enyx::hls_tools::cycle_count cycle; /// cycle count fed to the core, incremented on each call
 
 public:
     TopTestBench()
+        : cycle(0)
     {
         std::cout << ">>> Top Test #" << Index << " Begin" << std::endl;
 
@@ -76,7 +78,7 @@ private:
         int config_stimuli_count = dma_data_in.size();
         for (int i =0; i < config_stimuli_count; ++i) {
             std::cout << "[TB] Configuration related loop #" << std::dec << i << "\n";
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
         }
 
         read_nxbus_from_file(nxbus_in, generate_filename("nxbus_in", ".ref", Index, burst_index));
@@ -90,7 +92,7 @@ private:
         int input_stimuli_count = std::max(nxbus_in.size(), tcp_replies_in.size());
         for (int i =0; i < input_stimuli_count; ++i) {
             std::cout << "[TB] Main processing loop iteration#" << std::dec << i << "\n";
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
         }
 
         // ensure all entries where consumed, if not, there's a problem. For instance, some backpressure could be
@@ -102,7 +104,7 @@ private:
         for(int i = 0 ; i < TOTAL_ALGORITHM_EXPECTED_LATENCY; ++i)
         {
             std::cout << "[TB] Post processing loop iteration#" << std::dec << i << "\n";
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
         }
 
         {
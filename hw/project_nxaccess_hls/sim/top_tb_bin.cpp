@@ -20,11 +20,16 @@
 #include <vector>
 #include <iomanip>
 #include <utility>
+#include <map>
 
 #include "../include/enyx/hls/helpers.hpp"
 #include "../include/enyx/hls/string.hpp"
+#include "../include/enyx/hls/arbiter.hpp"
+#include "../include/enyx/hls/aggregator.hpp"
 
 #include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/md/hw/books.hpp"
+#include "../include/enyx/md/hw/instrument_map.hpp"
 #include "../include/enyx/md/hw/string.hpp"
 
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
@@ -32,6 +37,7 @@
 
 #include "../src/top.hpp"
 #include "../src/configuration.hpp"
+#include "../src/notifications.hpp"
 #include "../src/messages.hpp"
 #include "../include/enyx/hfp/hfp.hpp"
 #include "../include/enyx/oe/hwstrat/tcp.hpp"
@@ -40,6 +46,14 @@ namespace nxoe = enyx::oe::hwstrat;
 using _nxbus = enyx::md::hw::nxbus_axi;
 using _trigger_cmd = enyx::oe::hwstrat::trigger_command_axi;
 
+/// DMA egress words of all the bursts, timestamps cleared, replayed by check_notifications_aggregation()
+static std::vector<enyx::hfp::dma_user_channel_data_out> &
+dma_out_words()
+{
+    static std::vector<enyx::hfp::dma_user_channel_data_out> words;
+    return words;
+}
+
 template<std::size_t Index, std::size_t BurstCount>
 class TopTestBench
 {
@@ -47,9 +61,11 @@ public:
     static std::size_t const CYCLES_PER_MSG = 80;
 
 private:
+    enyx::hls_tools::cycle_count cycle; /// cycle count fed to the core, incremented on each call
 
 public:
     TopTestBench()
+        : cycle(0)
     {
         std::cout << ">>> Top Test #" << Index << " Begin" << std::endl;
 
@@ -77,7 +93,7 @@ private:
         std::cout << "[TB] Loaded " << std::dec << dma_data_in.size() << " configuration commands" << std::endl;
         int iteration = 0;
         while (! dma_data_in.empty()) {
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
             std::cout << "[TB] " << std::dec << 
                 "iteration #" << iteration << ": " <<
                 "dma_data_in: " << dma_data_in.size() << " words remaining" <<
@@ -93,10 +109,13 @@ private:
         
         std::cout << "[TB] Loading TCP reply data contents" << std::endl;
         
-        read_tcp_from_files(
-            tcp_replies_in,
-            "top_tb_tcp_bin/tcp_reply_session.ref.txt",
-            "top_tb_tcp_bin/tcp_reply_data.ref.txt");
+        // TCP replies are optional
+        std::string const tcp_sessions_file = generate_filename("tcp_reply_session", ".ref", Index, burst_index);
+        if (std::ifstream(tcp_sessions_file.c_str()))
+            read_tcp_from_files(
+                tcp_replies_in,
+                tcp_sessions_file,
+                generate_filename("tcp_reply_data", ".ref", Index, burst_index));
 
         std::cout << "[TB] Loaded " << std::dec << tcp_replies_in.size() << " TCP ingress words" << std::endl;
 
@@ -105,7 +124,7 @@ private:
         int input_stimuli_count = std::max(nxbus_in.size(), tcp_replies_in.size());
         for (int i =0; i < input_stimuli_count; ++i) {
             std::cout << "[TB] Main processing loop iteration#" << std::dec << i << std::endl;
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
             std::cout << "[TB] " << std::dec
                 << "remaining market data: " << nxbus_in.size() << " words, "
                 << "remaining TCP payload: " << tcp_replies_in.size() << " words, "
@@ -116,10 +135,10 @@ private:
         assert(nxbus_in.empty() && "HLS module failed to sink all market data words");
         assert(tcp_replies_in.empty() && "HLS module failed to sink all TCP reply words");
 
-        const int TOTAL_ALGORITHM_EXPECTED_LATENCY = 10;
+        const int TOTAL_ALGORITHM_EXPECTED_LATENCY = 32; // also drains the notifications, a DMA word per cycle
         for(int i = 0 ; i < TOTAL_ALGORITHM_EXPECTED_LATENCY; ++i)
         {
-            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in);
+            algorithm_entrypoint(nxbus_in, dma_data_in, dma_data_out, trigger_out, tcp_replies_in, cycle++);
             std::cout << "[TB] " << std::dec
                 << "remaining market data: " << nxbus_in.size() << " words, "
                 << "remaining TCP payload: " << tcp_replies_in.size() << " words, "
@@ -386,6 +405,22 @@ private:
         std::cout << "[VERBOSE] out.length: " << std::dec << out.length << std::endl;
     }
 
+    /// Reads the fields of a configuration following its header
+    static void
+    read_configuration_payload(enyx::oe::nxaccess_hw_algo::user_dma_update_instrument_configuration & out,
+                               std::istringstream & in)
+    {
+        out.tick_to_cancel_threshold =  enyx::get_from_hex_stream_as<uint64_t>(in);
+        out.tick_to_trade_bid_price =  enyx::get_from_hex_stream_as<uint64_t>(in);
+        out.tick_to_trade_ask_price =  enyx::get_from_hex_stream_as<uint64_t>(in);
+        out.instrument_id =  enyx::get_from_hex_stream_as<uint32_t>(in);
+        out.tick_to_trade_bid_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(in);
+        out.tick_to_cancel_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(in);
+        out.tick_to_trade_ask_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(in);
+
+        out.enabled =  enyx::get_from_hex_stream_as<uint16_t>(in);
+    }
+
     /// Converts strings representing DMA inputs to 128b words (enyx::hfp::dma_user_channel_data_in)
     static void
     convert_string_to_dma_channel_in(hls::stream<enyx::hfp::dma_user_channel_data_in> & result, std::string const& content)
@@ -394,7 +429,71 @@ private:
         enyx::oe::hwstrat::cpu2fpga_header pkt_header;
         convert_string_to_cpu2fpgaheader(pkt_header, ss);
 
-        if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration) {
+        if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration
+                && pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::ReadLatencyHistogram) {
+            // We want to read :
+            //        # cpu2fpga_header   | module | reset
+            //        1 8 5 0 00000042 0000 01       01
+            enyx::hfp::dma_user_channel_data_in out;
+            out.data(127, 64) = enyx::oe::hwstrat::get_word(pkt_header);
+            out.data(63, 56) = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            out.data(55, 48) = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            out.data(47, 0) = 0;
+            out.last = 1;
+            result.write(out);
+        } else if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration
+                && (pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::ReadNotificationsStatus
+                    || pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::ReadStatistics)) {
+            // We want to read :
+            //        # cpu2fpga_header
+            //        1 8 6 0 00000042 0000
+            enyx::hfp::dma_user_channel_data_in out;
+            out.data(127, 64) = enyx::oe::hwstrat::get_word(pkt_header);
+            out.data(63, 0) = 0;
+            out.last = 1;
+            result.write(out);
+        } else if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration
+                && pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::CommitConfigurationEpoch) {
+            // We want to read :
+            //        # cpu2fpga_header   | epoch
+            //        1 8 4 1 00000042 0000 07
+            enyx::hfp::dma_user_channel_data_in out;
+            out.data(127, 64) = enyx::oe::hwstrat::get_word(pkt_header);
+            out.data(63, 56) = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            out.data(55, 0) = 0;
+            out.last = 1;
+            result.write(out);
+        } else if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration
+                && pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::UpdateInstrumentDataBatch) {
+            // We want to read :
+            //        # cpu2fpga_header   | record_count | shadow_bank | records, each one laid out as the payload of a configuration
+            //        1 8 2 1 00000042 0000 0002           01            00000004A817C800 ... 01  00000004A817C800 ... 01
+            // The packet ends with the last record present: less records than record_count make a truncated batch.
+            enyx::hfp::dma_user_channel_data_in header_word;
+            header_word.data(127, 64) = enyx::oe::hwstrat::get_word(pkt_header);
+            header_word.data(63, 48) = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            header_word.data(47, 40) = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            header_word.data(39, 0) = 0;
+
+            std::vector<enyx::hfp::dma_user_channel_data_in> words(1, header_word);
+            while (ss >> std::ws, ! ss.eof()) {
+                enyx::oe::nxaccess_hw_algo::user_dma_update_instrument_configuration tmp;
+                tmp.header = pkt_header; // unused in records
+                read_configuration_payload(tmp, ss);
+                for(int i = 1; i <= 3; ++i)
+                {
+                    enyx::hfp::dma_user_channel_data_out word;
+                    enyx::hfp::dma_user_channel_data_in out;
+                    enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::write_word(tmp, word, i);
+                    out.data(127,0) = word.data(127,0);
+                    words.push_back(out);
+                }
+            }
+            for (std::size_t i = 0; i != words.size(); ++i) {
+                words[i].last = i == words.size() - 1;
+                result.write(words[i]);
+            }
+        } else if (pkt_header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration) {
             // We want to read :
             //        # cpu2fpga_header   | tick_to_cancel_threshold | tick_to_trade_bid_price | tick_to_trade_ask_price |  tick_to_trade_bid_collection_id | tick_to_cancel_collection_id | tick_to_trade_ask_collection_id | instrument_id|enable
             //        # version 1, module 8, msgtype 1 , ack request = 0 , reserved = 0, timestamp 0x42, length unused yet
@@ -403,15 +502,7 @@ private:
             enyx::oe::nxaccess_hw_algo::user_dma_update_instrument_configuration tmp;
 
             tmp.header = pkt_header;
-            tmp.tick_to_cancel_threshold =  enyx::get_from_hex_stream_as<uint64_t>(ss);
-            tmp.tick_to_trade_bid_price =  enyx::get_from_hex_stream_as<uint64_t>(ss);
-            tmp.tick_to_trade_ask_price =  enyx::get_from_hex_stream_as<uint64_t>(ss);
-            tmp.instrument_id =  enyx::get_from_hex_stream_as<uint32_t>(ss);
-            tmp.tick_to_trade_bid_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(ss);
-            tmp.tick_to_cancel_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(ss);
-            tmp.tick_to_trade_ask_collection_id =  enyx::get_from_hex_stream_as<uint16_t>(ss);
-
-            tmp.enabled =  enyx::get_from_hex_stream_as<uint16_t>(ss);
+            read_configuration_payload(tmp, ss);
 
             // convert input DMA message to 3 words as it would come into the FPGA
             for(int i = 1; i <= 3; ++i) 
@@ -442,30 +533,28 @@ private:
             tmp.padding_header[4] = enyx::get_from_hex_stream_as<uint16_t>(ss);
             std::cout << "tmp.padding_header[4]: " << std::hex << tmp.padding_header[4] << std::endl;
 
-            for (int i = 0; i < 16; i++){
-                tmp.arg0[i] = enyx::get_from_hex_stream_as<uint16_t>(ss);
-            }
-            for (int i = 0; i < 16; i++){
-                tmp.arg1[i] = enyx::get_from_hex_stream_as<uint16_t>(ss);
-            }
-            for (int i = 0; i < 16; i++){
-                tmp.arg2[i] = enyx::get_from_hex_stream_as<uint16_t>(ss);
-            }
-            for (int i = 0; i < 16; i++){
-                tmp.arg3[i] = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            // compact messages only hold the arguments present, packed from arg0
+            int arg_count = 5;
+            if (pkt_header.msg_type == enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::SoftwareTriggerCompact) {
+                arg_count = 0;
+                for (int i = 0; i < 5; i++)
+                    arg_count += (tmp.arg_bitmap >> i) & 1;
             }
-            for (int i = 0; i < 16; i++){
-                tmp.arg4[i] = enyx::get_from_hex_stream_as<uint16_t>(ss);
+            uint8_t * args[5] = { tmp.arg0, tmp.arg1, tmp.arg2, tmp.arg3, tmp.arg4 };
+            for (int arg = 0; arg < 5; arg++) {
+                for (int i = 0; i < 16; i++){
+                    args[arg][i] = arg < arg_count ? enyx::get_from_hex_stream_as<uint16_t>(ss) : 0;
+                }
             }
 
-            // convert input DMA message to 3 words as it would come into the FPGA
-            for(int i = 1; i <= 6; ++i) 
+            // convert input DMA message to words as it would come into the FPGA
+            for(int i = 1; i <= 1 + arg_count; ++i)
             {
                 enyx::hfp::dma_user_channel_data_out word;
                 enyx::hfp::dma_user_channel_data_in out;
                 enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::write_word(tmp, word, i);
                 out.data(127,0) = word.data(127,0);
-                out.last = word.last;
+                out.last = i == 1 + arg_count;
                 result.write(out);
             }
         }
@@ -551,6 +640,54 @@ private:
         return ret;
     }
 
+    /// Clears the hardware timestamps of the messages (header timestamp, and nxbus arrival of
+    /// the strategies notifications): they are cycle counts, which differ between C and RTL simulations.
+    /// Before, checks that the latency from the nxbus arrival to the trigger emission of each
+    /// strategy is the same for all its notifications, as no process stalls with the stimuli.
+    static void
+    clear_hw_timestamps(hls::stream<enyx::hfp::dma_user_channel_data_out> & in,
+                        hls::stream<enyx::hfp::dma_user_channel_data_out> & out)
+    {
+        static std::map<int, uint32_t> decision_latencies; /// per strategy, across the bursts
+        int message_word_index = 0;
+        int message_word_count = 0;
+        int source = 0;
+        uint32_t emission = 0;
+        while(!in.empty()) {
+            enyx::hfp::dma_user_channel_data_out word = in.read();
+            if (message_word_index == message_word_count) { // first word of a message
+                nxoe::fpga2cpu_header header;
+                nxoe::read_word(header, word.data(127, 64));
+                message_word_index = 0;
+                message_word_count = header.length / 16;
+                source = header.source;
+                emission = header.timestamp;
+                word.data(111, 80) = 0;
+            }
+            ++message_word_index;
+            if (message_word_index == 3 && (source == enyx::oe::nxaccess_hw_algo::Tick2cancel
+                                            || source == enyx::oe::nxaccess_hw_algo::Tick2trade)) {
+                ap_uint<32> arrival;
+                if (source == enyx::oe::nxaccess_hw_algo::Tick2cancel) {
+                    arrival = word.data(63, 32);
+                    word.data(63, 32) = 0;
+                } else {
+                    arrival = word.data(127, 96);
+                    word.data(127, 96) = 0;
+                }
+                uint32_t const latency = ap_uint<32>(emission - arrival);
+                std::cout << "[TB] strategy " << std::dec << source << " decision latency: " << latency << " cycles\n";
+                if (decision_latencies.count(source))
+                    ASSERT_EQ(decision_latencies[source], latency);
+                decision_latencies[source] = latency;
+            }
+            if (word.last)
+                message_word_index = message_word_count = 0;
+            dma_out_words().push_back(word);
+            out.write(word);
+        }
+    }
+
     static std::vector<std::string>
     write_dma_to_file(hls::stream<enyx::hfp::dma_user_channel_data_out> & dma_data, std::string const & file)
     {
@@ -559,9 +696,11 @@ private:
         std::ofstream data_out_file(file.c_str());
         assert(data_out_file);
         data_out_file << nxoe::get_dma_out_file_header() << std::endl;
+        hls::stream<enyx::hfp::dma_user_channel_data_out> dma_data_cleared;
+        clear_hw_timestamps(dma_data, dma_data_cleared);
         int acc = 0;
-        while(!dma_data.empty()) {
-            std::pair<std::string, bool> dma_out_info = nxoe::convert_dma_out_to_text(dma_data);
+        while(!dma_data_cleared.empty()) {
+            std::pair<std::string, bool> dma_out_info = nxoe::convert_dma_out_to_text(dma_data_cleared);
             std::string data = dma_out_info.first;
             bool end_of_line = dma_out_info.second;
             data_out_file << data;
@@ -595,12 +734,432 @@ private:
     }
 };
 
+/// Checks the drops counted by the notifications monitor. The C simulation streams never fill,
+/// so the drop counts the producers report on an overflowing notification FIFO are fed directly,
+/// after the top test bench as the monitor state is shared with the top instance.
+static void
+check_notifications_drops()
+{
+    namespace algo = enyx::oe::nxaccess_hw_algo;
+    std::cout << ">>> Notifications drops Begin" << std::endl;
+
+    hls::stream<algo::notification_drop> drops[algo::notification_producer_count];
+    hls::stream<algo::notifications_status_request> status_requests;
+    hls::stream<algo::notification_payload> status_out;
+    enyx::hls_tools::cycle_count cycle = 0;
+
+    // the first strategy reports 3 drops at once, the TCP consumer 1 then 1
+    algo::notification_drop pending_drops = 3;
+    algo::report_notification_drops(drops[0], pending_drops);
+    ASSERT_EQ(0, int(pending_drops));
+    for (int i = 0; i != 2; ++i) {
+        drops[algo::notification_producer_tcp_consumer].write(1);
+        algo::Notifications::p_monitor_notifications(drops, status_requests, status_out, cycle++);
+    }
+    ASSERT_EQ(true, status_out.empty());
+
+    status_requests.write(1);
+    algo::Notifications::p_monitor_notifications(drops, status_requests, status_out, cycle++);
+    ASSERT_EQ(false, status_out.empty());
+    algo::notification_payload const status = status_out.read();
+
+    ASSERT_EQ(3, int(status.word_count));
+    nxoe::fpga2cpu_header header;
+    nxoe::read_word(header, status.words[0].data(127, 64));
+    ASSERT_EQ(int(algo::NotificationsStatus), int(header.source));
+    ASSERT_EQ(int(algo::notification_bus_count), int(status.words[0].data(31, 24)));
+    uint32_t dropped[8];
+    for (int i = 0; i != 8; ++i)
+        dropped[i] = status.words[1 + i / 4].data(127 - 32 * (i % 4), 96 - 32 * (i % 4));
+    ASSERT_EQ(3u, dropped[0]);
+    ASSERT_EQ(0u, dropped[algo::notification_bus_configuration]);
+    ASSERT_EQ(2u, dropped[algo::notification_bus_tcp_consumer]);
+    ASSERT_EQ(0u, dropped[algo::notification_bus_statistics]);
+    ASSERT_EQ(0u, dropped[algo::notification_bus_status]);
+
+    std::cout << "<<< Notifications drops End" << std::endl;
+}
+
+/// Checks the events a module accumulates when they can't be sent to the statistics. The C
+/// simulation streams never fill, so the events held on a full FIFO are set directly.
+static void
+check_module_events()
+{
+    namespace algo = enyx::oe::nxaccess_hw_algo;
+    std::cout << ">>> Module events Begin" << std::endl;
+
+    hls::stream<algo::module_events_counts> events_out;
+
+    // nothing happened, nothing is sent
+    algo::module_events_counts pending;
+    algo::report_events(events_out, pending, algo::module_events());
+    ASSERT_EQ(true, events_out.empty());
+
+    // 2 triggers and a full cycle held, with the latency of the first trigger
+    pending.triggers = 2;
+    pending.decision_full_cycles = 1;
+    pending.trigger_latency_valid = 1;
+    pending.trigger_latency = 7;
+    algo::module_events events;
+    events.trigger = 1;
+    events.trigger_latency = 9;
+    events.decision_full = 1;
+    algo::report_events(events_out, pending, events);
+    ASSERT_EQ(1, int(events_out.size()));
+    algo::module_events_counts const sent = events_out.read();
+    ASSERT_EQ(3, int(sent.triggers));
+    ASSERT_EQ(2, int(sent.decision_full_cycles));
+    ASSERT_EQ(1, int(sent.trigger_latency_valid));
+    ASSERT_EQ(7, int(sent.trigger_latency));
+    ASSERT_EQ(1, int(sent.trigger_latencies_lost)); // the latency of the third trigger
+    ASSERT_EQ(0, int(pending.triggers));
+    ASSERT_EQ(0, int(pending.trigger_latency_valid));
+
+    // a software trigger has no latency
+    events = algo::module_events();
+    events.trigger = 1;
+    events.software_trigger = 1;
+    algo::report_events(events_out, pending, events);
+    algo::module_events_counts const software = events_out.read();
+    ASSERT_EQ(1, int(software.triggers));
+    ASSERT_EQ(1, int(software.software_triggers));
+    ASSERT_EQ(0, int(software.trigger_latency_valid));
+
+    std::cout << "<<< Module events End" << std::endl;
+}
+
+/// Word of the arbiters checks, tagged with its input, packet & index in the packet
+struct arbiter_test_word {
+    ap_uint<16> data;
+    ap_uint<1> last;
+};
+
+static arbiter_test_word
+make_arbiter_test_word(int input, int packet, int index, bool last)
+{
+    arbiter_test_word word;
+    word.data = (input << 8) | (packet << 4) | index;
+    word.last = last;
+    return word;
+}
+
+/// Writes the packets of an input, of the given word counts
+static void
+write_arbiter_test_packets(hls::stream<arbiter_test_word> & in, int input, std::vector<int> const& word_counts)
+{
+    for (std::size_t packet = 0; packet != word_counts.size(); ++packet)
+        for (int i = 0; i != word_counts[packet]; ++i)
+            in.write(make_arbiter_test_word(input, packet, i, i == word_counts[packet] - 1));
+}
+
+/// Reads the arbiter output, checking that the packets are contiguous and that the packets of
+/// each input keep their order. Returns the inputs of the packets, in output order.
+static std::vector<int>
+read_arbiter_test_packets(hls::stream<arbiter_test_word> & out)
+{
+    std::vector<int> inputs;
+    std::map<int, int> next_packets; /// per input
+    int index = 0; /// of the next word in its packet
+    while (! out.empty()) {
+        arbiter_test_word const word = out.read();
+        int const input = word.data >> 8;
+        int const packet = (word.data >> 4) & 0xf;
+        if (index == 0) {
+            inputs.push_back(input);
+            ASSERT_EQ(next_packets[input], packet);
+        } else {
+            ASSERT_EQ(inputs.back(), input); // a packet is never interrupted
+        }
+        ASSERT_EQ(index, int(word.data & 0xf));
+        if (word.last) {
+            ++next_packets[input];
+            index = 0;
+        } else {
+            ++index;
+        }
+    }
+    ASSERT_EQ(0, index); // no truncated packet
+    return inputs;
+}
+
+/// Checks the inputs of the packets read by read_arbiter_test_packets()
+static void
+check_arbiter_test_inputs(std::vector<int> const& inputs, int const* expected, std::size_t count)
+{
+    ASSERT_EQ(count, inputs.size());
+    for (std::size_t i = 0; i != count; ++i)
+        ASSERT_EQ(expected[i], inputs[i]);
+}
+
+/// The priority arbiter check classes: input 0 after the others
+struct arbiter_test_classes
+{
+    static const std::size_t class_count = 2;
+
+    static std::size_t
+    priority_class(std::size_t input)
+    {
+        return input == 0 ? 1 : 0;
+    }
+};
+
+/// Checks the packets contiguity and order of the arbiters, and the one-hot arbiter throughput
+static void
+check_arbiters()
+{
+    std::cout << ">>> Arbiters Begin" << std::endl;
+
+    {
+        struct onehot_arbiter_rate_test {};
+        typedef enyx::hls_tools::onehot_arbiter<onehot_arbiter_rate_test, 4, arbiter_test_word> arbiter_type;
+        hls::stream<arbiter_test_word> in[4];
+        hls::stream<arbiter_test_word> out;
+
+        // a single busy input gets a word per cycle, after the cycle of its grant
+        write_arbiter_test_packets(in[2], 2, std::vector<int>(8, 1));
+        for (int cycle = 0; cycle != 1 + 8; ++cycle)
+            arbiter_type::p_arbitrate(in, out);
+        ASSERT_EQ(8, int(out.size()));
+        int const expected[] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+        check_arbiter_test_inputs(read_arbiter_test_packets(out), expected, 8);
+
+        // its next packet is read at once, as no other input has one pending
+        write_arbiter_test_packets(in[2], 2, std::vector<int>(1, 2));
+        arbiter_type::p_arbitrate(in, out);
+        ASSERT_EQ(1, int(out.size()));
+    }
+
+    {
+        struct onehot_arbiter_packets_test {};
+        typedef enyx::hls_tools::onehot_arbiter<onehot_arbiter_packets_test, 4, arbiter_test_word> arbiter_type;
+        hls::stream<arbiter_test_word> in[4];
+        hls::stream<arbiter_test_word> out;
+
+        int const counts_0[] = { 3, 2 };
+        int const counts_1[] = { 2 };
+        int const counts_3[] = { 1, 1, 4 };
+        write_arbiter_test_packets(in[0], 0, std::vector<int>(counts_0, counts_0 + 2));
+        write_arbiter_test_packets(in[1], 1, std::vector<int>(counts_1, counts_1 + 1));
+        write_arbiter_test_packets(in[3], 3, std::vector<int>(counts_3, counts_3 + 3));
+        for (int cycle = 0; cycle != 1 + 13; ++cycle)
+            arbiter_type::p_arbitrate(in, out);
+        ASSERT_EQ(13, int(out.size())); // a word per cycle, packets of different inputs included
+
+        // round robin between the pending inputs, then the last one alone
+        int const expected[] = { 0, 1, 3, 0, 3, 3 };
+        check_arbiter_test_inputs(read_arbiter_test_packets(out), expected, 6);
+    }
+
+    {
+        struct priority_arbiter_test {};
+        typedef enyx::hls_tools::priority_arbiter<priority_arbiter_test, 4, arbiter_test_word,
+                                                  arbiter_test_classes> arbiter_type;
+        hls::stream<arbiter_test_word> in[4];
+        hls::stream<arbiter_test_word> out;
+
+        int const counts_0[] = { 2 };
+        int const counts_1[] = { 2, 1 };
+        int const counts_2[] = { 3 };
+        write_arbiter_test_packets(in[0], 0, std::vector<int>(counts_0, counts_0 + 1));
+        write_arbiter_test_packets(in[1], 1, std::vector<int>(counts_1, counts_1 + 2));
+        write_arbiter_test_packets(in[2], 2, std::vector<int>(counts_2, counts_2 + 1));
+        for (int cycle = 0; cycle != 8; ++cycle)
+            arbiter_type::p_arbitrate(in, out);
+        ASSERT_EQ(8, int(out.size()));
+
+        // the class 0 inputs in round robin, then input 0 of class 1
+        int const expected[] = { 1, 2, 1, 0 };
+        check_arbiter_test_inputs(read_arbiter_test_packets(out), expected, 4);
+    }
+
+    std::cout << "<<< Arbiters End" << std::endl;
+}
+
+/// Builds a single word nxbus command
+static enyx::md::hw::nxbus_axi
+make_instrument_map_test_command(uint8_t opcode, uint32_t instr_id)
+{
+    enyx::md::hw::nxbus word;
+    word.end_of_extra = 1;
+    word.market_internal_id = 0;
+    word.opcode = opcode;
+    word.order_id = 0;
+    word.buy_nsell = 1;
+    word.qty = 5;
+    word.price = 0x174876E800; // 10$
+    word.timestamp = 0;
+    word.instr_ascii = 0;
+    word.instr_bin = 0;
+    word.instr_id = instr_id;
+    word.data0 = 0;
+    word.data1 = 0;
+    word.data2 = 0; // level 0
+    enyx::md::hw::nxbus_axi out = word;
+    out.user = 0;
+    out.last = 1;
+    return out;
+}
+
+/// Maps the instrument of a command, appended to 'mapped', returns its slot
+template<typename Map>
+static int
+map_instrument_map_test_command(hls::stream<typename Map::map_update> & map_updates,
+                                hls::stream<enyx::md::hw::nxbus_axi> & mapped,
+                                uint8_t opcode, uint32_t instr_id)
+{
+    hls::stream<enyx::md::hw::nxbus_axi> nxbus;
+    hls::stream<enyx::md::hw::nxbus_axi> out;
+    nxbus.write(make_instrument_map_test_command(opcode, instr_id));
+    Map::p_map_nxbus(nxbus, map_updates, out);
+    enyx::md::hw::nxbus_axi const command = out.read();
+    mapped.write(command);
+    return int(command.user);
+}
+
+/// Checks the instrument map slots allocation, the nxbus mapping, and that the book updates
+/// of the unknown instruments are dropped
+static void
+check_instrument_map()
+{
+    std::cout << ">>> Instrument map Begin" << std::endl;
+
+    // 7 slots, 8 sets of 2 ways: the 3 bits chunks of the instrument ids are xor-ed to get their set
+    struct instrument_map_test {};
+    typedef enyx::md::hw::InstrumentMap<instrument_map_test, 8, 2> map_type;
+    hls::stream<map_type::map_update> map_updates;
+
+    map_type::slot slot;
+    bool inserted;
+    map_type::map_update update;
+
+    // an instrument id wider than the slot
+    ASSERT_EQ(true, map_type::find_or_insert(0x1234, slot, inserted, update));
+    ASSERT_EQ(true, inserted);
+    ASSERT_EQ(1, int(slot));
+    map_updates.write(update);
+    ASSERT_EQ(true, map_type::find_or_insert(0x1234, slot, inserted, update));
+    ASSERT_EQ(false, inserted);
+    ASSERT_EQ(1, int(slot));
+
+    // 0x106 fills the set of 0x1234 (set 2), 0x10f doesn't fit in it
+    ASSERT_EQ(true, map_type::find_or_insert(0x106, slot, inserted, update));
+    ASSERT_EQ(2, int(slot));
+    map_updates.write(update);
+    ASSERT_EQ(false, map_type::find_or_insert(0x10f, slot, inserted, update));
+    ASSERT_EQ(false, inserted);
+
+    // the slots are exhausted after 7 instruments, whatever the free ways
+    for (uint32_t instr_id = 0x300; instr_id != 0x305; ++instr_id) {
+        ASSERT_EQ(true, map_type::find_or_insert(instr_id, slot, inserted, update));
+        ASSERT_EQ(int(instr_id - 0x300 + 3), int(slot));
+        map_updates.write(update);
+    }
+    ASSERT_EQ(false, map_type::find_or_insert(0x305, slot, inserted, update));
+    ASSERT_EQ(false, inserted);
+    ASSERT_EQ(true, map_type::find_or_insert(0x304, slot, inserted, update));
+    ASSERT_EQ(7, int(slot));
+
+    // the nxbus mapper gets the map updates, one per cycle
+    hls::stream<enyx::md::hw::nxbus_axi> nxbus;
+    hls::stream<enyx::md::hw::nxbus_axi> mapped;
+    while (! map_updates.empty())
+        map_type::p_map_nxbus(nxbus, map_updates, mapped);
+
+    ASSERT_EQ(1, map_instrument_map_test_command<map_type>(map_updates, mapped, enyx::md::hw::NXBUS_OPCODE_BOOK_UPDATE, 0x1234));
+    ASSERT_EQ(2, map_instrument_map_test_command<map_type>(map_updates, mapped, enyx::md::hw::NXBUS_OPCODE_BOOK_UPDATE, 0x106));
+    ASSERT_EQ(int(map_type::UnknownSlot), map_instrument_map_test_command<map_type>(map_updates, mapped, enyx::md::hw::NXBUS_OPCODE_BOOK_UPDATE, 0x10f));
+    ASSERT_EQ(7, map_instrument_map_test_command<map_type>(map_updates, mapped, enyx::md::hw::NXBUS_OPCODE_BOOK_UPDATE, 0x304));
+    ASSERT_EQ(int(map_type::UnknownSlot), map_instrument_map_test_command<map_type>(map_updates, mapped, enyx::md::hw::NXBUS_OPCODE_BOOK_UPDATE, 0x305));
+
+    // the book updates of the unknown instruments are dropped
+    typedef enyx::md::hw::BooksData<1, 8, 1> books_type;
+    hls::stream<books_type::halfbook_entry_update_request> book_updates;
+    while (! mapped.empty())
+        books_type::p_book_updates(mapped, book_updates);
+    ASSERT_EQ(3, int(book_updates.size()));
+    int const expected[] = { 1, 2, 7 };
+    for (int i = 0; i != 3; ++i)
+        ASSERT_EQ(expected[i], int(book_updates.read().book_index));
+
+    std::cout << "<<< Instrument map End" << std::endl;
+}
+
+/// Aggregates the DMA egress messages of the top test bench in packets of up to 8 words, as with
+/// notification_packet_max_word_count = 8, then walks the packets as the software AlgorithmDispatcher
+/// does, using the header length of each message: the walk shall give back every message.
+static void
+check_notifications_aggregation()
+{
+    std::cout << ">>> Notifications aggregation Begin" << std::endl;
+
+    typedef enyx::hfp::dma_user_channel_data_out word_type;
+    std::size_t const packet_max_word_count = 8;
+    struct notifications_aggregation_test {};
+    typedef enyx::hls_tools::aggregator<notifications_aggregation_test, word_type, packet_max_word_count,
+                                        enyx::oe::nxaccess_hw_algo::notification_payload::max_word_count,
+                                        4> aggregator_type;
+
+    std::vector<word_type> const& messages = dma_out_words();
+    hls::stream<word_type> in;
+    hls::stream<word_type> out;
+    for (std::size_t i = 0; i != messages.size(); ++i)
+        in.write(messages[i]);
+    for (std::size_t cycle = 0; cycle != messages.size() + 1 + 4 + 1; ++cycle) // up to the timeout flush
+        aggregator_type::p_aggregate(in, out);
+    ASSERT_EQ(int(messages.size()), int(out.size()));
+
+    std::size_t word_index = 0; // next message of the egress
+    int packet_count = 0;
+    int message_count = 0;
+    while (! out.empty()) {
+        std::vector<word_type> packet;
+        do {
+            packet.push_back(out.read());
+        } while (! packet.back().last && ! out.empty());
+        ASSERT_EQ(true, bool(packet.back().last));
+        ASSERT_EQ(true, packet.size() <= packet_max_word_count);
+        ++packet_count;
+
+        for (std::size_t offset = 0; offset != packet.size(); ) {
+            nxoe::fpga2cpu_header header;
+            nxoe::read_word(header, packet[offset].data(127, 64));
+            ASSERT_EQ(1, int(header.version));
+            ASSERT_EQ(0, int(header.length % 16)); // the next message starts on a word
+            std::size_t const word_count = header.length / 16;
+            ASSERT_EQ(true, word_count != 0 && offset + word_count <= packet.size());
+
+            // the message is the next one of the egress, and ends there
+            for (std::size_t i = 0; i != word_count; ++i)
+                ASSERT_EQ(true, packet[offset + i].data == messages[word_index + i].data);
+            ASSERT_EQ(1, int(messages[word_index + word_count - 1].last));
+
+            offset += word_count;
+            word_index += word_count;
+            ++message_count;
+        }
+    }
+    ASSERT_EQ(int(messages.size()), int(word_index));
+    std::cout << "[TB] " << std::dec << message_count << " messages aggregated in " << packet_count << " packets\n";
+    ASSERT_EQ(true, packet_count < message_count);
+
+    std::cout << "<<< Notifications aggregation End" << std::endl;
+}
+
 int
 main(int argc, char** argv)
 {
 
-    TopTestBench<0, 1>();
+    TopTestBench<0, 12>();
+
+    check_notifications_drops();
+
+    check_module_events();
+
+    check_arbiters();
+
+    check_instrument_map();
 
+    check_notifications_aggregation();
 
     return 0;
 }
@@ -17,6 +17,7 @@
 #include "messages.hpp"
 
 #include "../include/enyx/oe/hwstrat/helpers.hpp"
+#include "../include/enyx/hls/clock.hpp"
 
 namespace enyx {
 namespace oe {
@@ -277,6 +278,127 @@ InstrumentConfiguration::write_word(const user_dma_update_instrument_configurati
     }
 }
 
+/// Converts data words from User DMA to software message structure
+void
+InstrumentConfiguration::read_word(user_dma_update_instrument_configuration_batch& ret, const enyx::hfp::dma_user_channel_data_in& word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        enyx::oe::hwstrat::read_word(ret.header, word.data(127,64));
+        ret.record_count = word.data(63,48);
+        ret.shadow_bank = word.data(47,40);
+        break;
+    }
+    default:
+        assert(false && "Handling only 1 word for user_dma_update_instrument_configuration_batch decoding");
+    }
+}
+
+/// Converts configuration batch ack to software message structure to data words
+void
+InstrumentConfiguration::write_word(const user_dma_update_instrument_configuration_batch_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        out_word.data(127, 64) =  enyx::oe::hwstrat::get_word(in.header); //64
+        out_word.data(63, 48) = in.applied_count; //16
+        out_word.data(47, 32) = in.rejected_count; //16
+        out_word.data(31, 0) = in.first_rejected_instrument_id; //32
+        out_word.last = 1;
+        break;
+    }
+    default:
+        assert(false && "Handling only 1 word for user_dma_update_instrument_configuration_batch_ack decoding");
+    }
+}
+
+/// Converts configuration coalesced ack to software message structure to data words
+void
+InstrumentConfiguration::write_word(const user_dma_update_instrument_configuration_coalesced_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        out_word.data(127, 64) =  enyx::oe::hwstrat::get_word(in.header); //64
+        out_word.data(63, 32) = in.base_instrument_id; //32
+        out_word.data(31, 16) = in.applied_count; //16
+        out_word.data(15, 0) = in.rejected_count; //16
+        out_word.last = 0;
+        break;
+    }
+    case 2: {
+        out_word.data(127, 64) = in.applied_bitmap; //64
+        out_word.data(63, 0) = in.rejected_bitmap; //64
+        out_word.last = 1;
+        break;
+    }
+    default:
+        assert(false && "Handling only 2 words for user_dma_update_instrument_configuration_coalesced_ack decoding");
+    }
+}
+
+/// Converts data words from User DMA to software message structure
+void
+InstrumentConfiguration::read_word(user_dma_commit_configuration_epoch& ret, const enyx::hfp::dma_user_channel_data_in& word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        enyx::oe::hwstrat::read_word(ret.header, word.data(127,64));
+        ret.epoch = word.data(63,56);
+        break;
+    }
+    default:
+        assert(false && "Handling only 1 word for user_dma_commit_configuration_epoch decoding");
+    }
+}
+
+/// Converts data words from User DMA to software message structure
+void
+InstrumentConfiguration::read_word(user_dma_read_latency_histogram& ret, const enyx::hfp::dma_user_channel_data_in& word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        enyx::oe::hwstrat::read_word(ret.header, word.data(127,64));
+        ret.module = word.data(63,56);
+        ret.reset = word.data(55,48);
+        break;
+    }
+    default:
+        assert(false && "Handling only 1 word for user_dma_read_latency_histogram decoding");
+    }
+}
+
+/// Converts configuration epoch commit ack to software message structure to data words
+void
+InstrumentConfiguration::write_word(const user_dma_commit_configuration_epoch_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index) {
+   #pragma HLS function_instantiate variable=word_index
+    switch(word_index) {
+    case 1: {
+        out_word.data(127, 64) =  enyx::oe::hwstrat::get_word(in.header); //64
+        out_word.data(63, 56) = in.epoch; //8
+        out_word.data(56-1, 0) = 0;
+        out_word.last = 1;
+        break;
+    }
+    default:
+        assert(false && "Handling only 1 word for user_dma_commit_configuration_epoch_ack decoding");
+    }
+}
+
+/// Converts a configuration message ack to DMA words, stamped with its emission cycle
+template<int WordCount, typename Ack>
+notification_payload
+pack_ack(Ack const& ack, ap_uint<32> emission)
+{
+    #pragma HLS INLINE
+    Ack stamped_ack = ack;
+    stamped_ack.header.timestamp = emission;
+    notification_payload ret;
+    for (int i = 0; i != WordCount; ++i)
+        InstrumentConfiguration::write_word(stamped_ack, ret.words[i], i + 1);
+    ret.word_count = WordCount;
+    return ret;
+}
+
 std::ostream& operator<<(std::ostream& os, const user_dma_update_instrument_configuration& conf)
 {
     os << "header: " << conf.header << "\n"
@@ -291,52 +413,209 @@ std::ostream& operator<<(std::ostream& os, const user_dma_update_instrument_conf
     return os;
 }
 
+/// Applies a configuration message: finds the instrument slot (allocating one for a new
+/// instrument) and sends the configuration update to the configuration memory server,
+/// for the active or the shadow bank. Returns false if no instrument slot is available.
+bool
+apply_configuration(const user_dma_update_instrument_configuration& msg,
+                    bool shadow,
+                    hls::stream<InstrumentMap::map_update> & map_updates_out,
+                    hls::stream<InstrumentConfiguration::instrument_configuration_update> & config_updates_out) {
+#pragma HLS INLINE
+    // find the instrument slot, allocate one for a new instrument
+    InstrumentMap::slot slot;
+    bool slot_allocated;
+    InstrumentMap::map_update map_update;
+    bool const mapped = InstrumentMap::find_or_insert(msg.instrument_id,
+                                                      slot, slot_allocated, map_update);
+    if (slot_allocated)
+        map_updates_out.write(map_update); // let the nxbus mapper know about the new instrument
+
+    if (mapped) {
+        // convert it to instrument_configuration_data_item, and let the configuration memory server store it
+        InstrumentConfiguration::instrument_configuration_update config_update;
+        config_update.slot = slot;
+        convert(config_update.config, msg);
+        config_update.shadow = shadow;
+        config_update.commit = 0;
+        config_update.epoch = 0;
+        config_updates_out.write(config_update);
+
+        std::cout << "[CONF] Configuration for instrument "
+                  << std::hex << std::showbase << msg.instrument_id
+                  << std::dec<< " updated (slot " << slot << (shadow ? ", shadow bank" : "") << ")."
+                  << " tick_to_cancel_threshold=" << std::hex << msg.tick_to_cancel_threshold
+                  << " tick_to_cancel_collid=" <<    std::hex << msg.tick_to_cancel_collection_id
+                  << "\n";
+    } else {
+        std::cout << "[WARNING][CONF] Configuration for instrument "
+                  << std::hex << std::showbase << msg.instrument_id
+                  << " rejected, no instrument slot available.\n";
+    }
+    return mapped;
+}
+
 void
 InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp::dma_user_channel_data_in> & conf_in,
-                                                          hls::stream<InstrumentConfiguration::read_instrument_data_request> (& req_in)[2],
-                                                          hls::stream<instrument_configuration_data_item> (& req_out)[2],
-                                                          hls::stream<user_dma_update_instrument_configuration_ack> & conf_out,
-                                                          hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output) {
+                                                          hls::stream<notification_payload> & conf_out,
+                                                          hls::stream<module_events_counts> & events_out,
+                                                          hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output,
+                                                          hls::stream<InstrumentMap::map_update> & map_updates_out,
+                                                          hls::stream<instrument_configuration_update> & config_updates_out,
+                                                          hls::stream<latency_histogram_request> & histogram_requests_out,
+                                                          hls::stream<statistics_request> & statistics_requests_out,
+                                                          hls::stream<notifications_status_request> & status_requests_out,
+                                                          enyx::hls_tools::cycle_count now) {
 
 #pragma HLS INLINE recursive
 #pragma HLS PIPELINE enable_flush
 
+    static module_events_counts pending_events; /// events not sent to the statistics yet
+#pragma HLS RESET variable=pending_events
+
+    module_events events;
+    events.decision_full = output.full();
+    events.notification_full = conf_out.full();
+
     static enum  { IDLE,  /// doing nothing
                    IGNORE_PACKET, /// ignore incoming packet
                    READ_CONF_WORD2, /// will process word 2 of DMA input
                    READ_CONF_WORD3, /// will process word 3 of DMA input
+                   READ_BATCH_RECORD_WORD1, /// will process word 1 of a batch record
+                   READ_BATCH_RECORD_WORD2, /// will process word 2 of a batch record
+                   READ_BATCH_RECORD_WORD3, /// will process word 3 of a batch record, and apply it
                    READ_SW_TRIG_ARG1,
                    READ_SW_TRIG_ARG2,
                    READ_SW_TRIG_ARG3,
                    READ_SW_TRIG_ARG4,
-                   READ_SW_TRIG_ARG5_ISSUE_TRIG
+                   READ_SW_TRIG_ARG5_ISSUE_TRIG,
+                   READ_SW_TRIG_COMPACT_ARG /// will process an argument of a compact software trigger
                  } current_state; /// current state in FSM
     #pragma HLS RESET variable=current_state
 
     static user_dma_update_instrument_configuration current_dma_message_read; /// DMA message being parsed message.
     static user_dma_software_trigger_message current_software_trigger_message_read; /// DMA message being parsed message.
     #pragma HLS RESET variable=current_software_trigger_message_read
+    static ap_uint<nxoe::trigger_meta_size::TRIGGER_SIZE_ARG0> compact_trigger_args[5]; /// arguments of the compact software trigger being parsed
+    #pragma HLS ARRAY_PARTITION variable=compact_trigger_args complete dim=1
+    static ap_uint<5> compact_trigger_args_left; /// arguments of the compact software trigger not received yet
+    #pragma HLS RESET variable=compact_trigger_args_left
+
+    static user_dma_update_instrument_configuration_batch current_batch_read; /// DMA batch header being processed.
+    static user_dma_update_instrument_configuration_batch_ack current_batch_ack; /// summary ack of the batch being processed.
+    static ap_uint<16> batch_records_left; /// records of the batch not processed yet
+    #pragma HLS RESET variable=batch_records_left
 
-    static instrument_configuration_data_item write_data ;
-    static InstrumentConfiguration::instrument_configuration_data_item values[InstrumentConfiguration::instrument_count];
-#pragma HLS RESOURCE variable=values core=XPM_MEMORY uram 
+    static user_dma_update_instrument_configuration_coalesced_ack current_coalesced_ack; /// coalesced ack being filled.
+    static bool coalesced_ack_pending = false; /// some configurations are reported in current_coalesced_ack
+    #pragma HLS RESET variable=coalesced_ack_pending
+    static bool coalesced_ack_flush = false; /// current_coalesced_ack is to be sent on next IDLE cycle
+    #pragma HLS RESET variable=coalesced_ack_flush
 
     switch(current_state) {
 
     case IDLE:
     {
-            if(!conf_in.empty()) {
-                
+            if(coalesced_ack_flush) {
+                // the previous message asked for an ack while filling a new coalesced ack
+                conf_out.write(pack_ack<2>(current_coalesced_ack, now));
+                coalesced_ack_pending = false;
+                coalesced_ack_flush = false;
+            } else if(!conf_in.empty()) {
+
                    enyx::hfp::dma_user_channel_data_in _read = conf_in.read();
                    read_word(current_dma_message_read, _read, 1); // convert word 1 into struct
                    if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
-                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::UpdateInstrumentData)
+                           && ((current_dma_message_read.header.msg_type == InstrumentConfiguration::UpdateInstrumentData)
+                               || (current_dma_message_read.header.msg_type == InstrumentConfiguration::UpdateInstrumentDataCoalescedAck))
                            && (current_dma_message_read.header.version == 1))
                    {
                        std::cout << "[CONF] Incoming configuration message : accepted. ack_request="
                                  << int(current_dma_message_read.header.ack_request)  << "\n";
 
                        current_state = READ_CONF_WORD2; // now process second word of packet
+                   } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
+                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::UpdateInstrumentDataBatch)
+                           && (current_dma_message_read.header.version == 1))
+                   {
+                       read_word(current_batch_read, _read, 1);
+                       std::cout << "[CONF] Incoming configuration batch message : accepted, "
+                                 << std::dec << current_batch_read.record_count << " records.\n";
+
+                       current_batch_ack.header.reserved = 0;
+                       current_batch_ack.header.error = 0;
+                       current_batch_ack.header.version = 1;
+                       current_batch_ack.header.source = enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration;
+                       current_batch_ack.header.msg_type = InstrumentConfiguration::UpdateInstrumentDataBatch;
+                       current_batch_ack.header.length = 0x0010; // sizeof(user_dma_update_instrument_configuration_batch_ack)
+                       current_batch_ack.applied_count = 0;
+                       current_batch_ack.rejected_count = 0;
+                       current_batch_ack.first_rejected_instrument_id = 0;
+                       batch_records_left = current_batch_read.record_count;
+
+                       if (current_batch_read.record_count == 0 || _read.last == 1) {
+                           // nothing to apply
+                           current_batch_ack.header.error = current_batch_read.record_count != 0;
+                           if (current_batch_read.header.ack_request)
+                               conf_out.write(pack_ack<1>(current_batch_ack, now));
+                           current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+                       } else {
+                           current_state = READ_BATCH_RECORD_WORD1;
+                       }
+                   } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
+                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::CommitConfigurationEpoch)
+                           && (current_dma_message_read.header.version == 1))
+                   {
+                       user_dma_commit_configuration_epoch commit;
+                       read_word(commit, _read, 1);
+                       std::cout << "[CONF] Incoming configuration epoch commit, epoch: " << std::dec << int(commit.epoch) << "\n";
+
+                       // swap the banks of the configuration memories
+                       instrument_configuration_update config_update = instrument_configuration_update();
+                       config_update.commit = 1;
+                       config_update.epoch = commit.epoch;
+                       config_updates_out.write(config_update);
+
+                       if (commit.header.ack_request) {
+                           user_dma_commit_configuration_epoch_ack ack;
+                           ack.header.reserved = 0;
+                           ack.header.error = 0;
+                           ack.header.version = 1;
+                           ack.header.source = enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration;
+                           ack.header.msg_type = InstrumentConfiguration::CommitConfigurationEpoch;
+                           ack.header.length = 0x0010; // sizeof(user_dma_commit_configuration_epoch_ack)
+                           ack.epoch = commit.epoch;
+                           conf_out.write(pack_ack<1>(ack, now));
+                       }
+                       current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+                   } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
+                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::ReadLatencyHistogram)
+                           && (current_dma_message_read.header.version == 1))
+                   {
+                       user_dma_read_latency_histogram read;
+                       read_word(read, _read, 1);
+                       std::cout << "[CONF] Incoming latency histogram read, module: " << std::dec << int(read.module)
+                                 << " reset: " << int(read.reset) << "\n";
+
+                       latency_histogram_request request;
+                       request.module = read.module;
+                       request.reset = read.reset != 0;
+                       histogram_requests_out.write(request); // answered by the statistics
+                       current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+                   } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
+                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::ReadNotificationsStatus)
+                           && (current_dma_message_read.header.version == 1))
+                   {
+                       std::cout << "[CONF] Incoming notifications status read\n";
+                       status_requests_out.write(1); // answered by the notifications monitor
+                       current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+                   } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration)
+                           && (current_dma_message_read.header.msg_type == InstrumentConfiguration::ReadStatistics)
+                           && (current_dma_message_read.header.version == 1))
+                   {
+                       std::cout << "[CONF] Incoming statistics read\n";
+                       statistics_requests_out.write(1); // answered by the statistics
+                       current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
                    } else if((current_dma_message_read.header.dest == enyx::oe::nxaccess_hw_algo::SoftwareTrigger)
                            && (current_dma_message_read.header.version == 1))
                    {
@@ -345,21 +624,29 @@ InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp
                                 << "collection_id: " << std::hex << current_software_trigger_message_read.collection_id << " "
                                 << "arg_bitmap: " << std::hex << (int) current_software_trigger_message_read.arg_bitmap << " "
                                 << "\n";
-                        current_state = READ_SW_TRIG_ARG1;
+                       if (current_software_trigger_message_read.header.msg_type == InstrumentConfiguration::SoftwareTriggerCompact) {
+                           compact_trigger_args_left = current_software_trigger_message_read.arg_bitmap;
+                           for (int i = 0; i != 5; ++i)
+                               compact_trigger_args[i] = 0;
+
+                           if (compact_trigger_args_left == 0) {
+                               // no argument: the header is the last word
+                               nxoe::trigger_collection(output, current_software_trigger_message_read.collection_id);
+                               events.trigger = 1;
+                               events.software_trigger = 1;
+                               current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+                           } else {
+                               current_state = READ_SW_TRIG_COMPACT_ARG;
+                           }
+                       } else {
+                           current_state = READ_SW_TRIG_ARG1;
+                       }
 
                    } else {
                        std::cout << "[WARNING][CONF] Incoming configuration message : message unknown, ignoring ! \n" ;
                        current_state = IGNORE_PACKET;
                    }
 
-            } else {
-                // process read requests from read request bus
-                for(int i = 0; i != 2; ++i) {
-                    if(!req_in[i].empty()) {
-                        req_out[i].write(values[req_in[i].read()]);
-                    }
-                }
-
             }
             break;
     }
@@ -370,11 +657,6 @@ InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp
             read_word(current_dma_message_read, _read, 2); // convert word 2 into struct
             current_state = READ_CONF_WORD3;
         }
-        for(int i = 0; i != 2; ++i) {
-            if(!req_in[i].empty()) {
-                req_out[i].write(values[req_in[i].read()]);
-            }
-        }
         break;
     }
     case READ_CONF_WORD3:{
@@ -383,43 +665,126 @@ InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp
             std::cout << "[CONF] processing word 3 of configuration message \n";
             enyx::hfp::dma_user_channel_data_in _read = conf_in.read();
             read_word(current_dma_message_read, _read, 3); // convert word 4 into struct
-            // convert it to instrument_configuration_data_item
-            convert(write_data, current_dma_message_read);
-            values[current_dma_message_read.instrument_id] = write_data;
-
-            std::cout << "[CONF] Configuration for instrument "
-                      << std::hex << std::showbase << current_dma_message_read.instrument_id
-                      << std::dec<< " updated."
-                      << " tick_to_cancel_threshold=" << std::hex << current_dma_message_read.tick_to_cancel_threshold
-                      << " tick_to_cancel_collid=" <<    std::hex << current_dma_message_read.tick_to_cancel_collection_id
-                      << "\n";
-
-            user_dma_update_instrument_configuration_ack ack;
-            //header
-            ack.header.reserved = 0;
-            ack.header.timestamp = 0;
-            ack.header.error = 0;
-            ack.header.version = 1;
-            ack.header.source = enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration;
-            ack.header.msg_type = InstrumentConfiguration::UpdateInstrumentData; // only notifications
-            ack.header.length = 0x0030; // force length value since sizeof yield incorrect value because vivado (as of 2018.3) has trouble with packed structure
-            //ack.header.length = sizeof(user_dma_update_instrument_configuration_ack); //unused here, shall be needed for retrocompat'. We put here a dump value.
-            //applicative layer 
-            ack.instrument_id = current_dma_message_read.instrument_id;
-            ack.enabled = current_dma_message_read.enabled;
-            ack.tick_to_cancel_collection_id = current_dma_message_read.tick_to_cancel_collection_id;
-            ack.tick_to_cancel_threshold = current_dma_message_read.tick_to_cancel_threshold;
-            ack.tick_to_trade_ask_collection_id = current_dma_message_read.tick_to_trade_ask_collection_id;
-            ack.tick_to_trade_ask_price = current_dma_message_read.tick_to_trade_ask_price;
-            ack.tick_to_trade_bid_collection_id = current_dma_message_read.tick_to_trade_bid_collection_id;
-            ack.tick_to_trade_bid_price = current_dma_message_read.tick_to_trade_bid_price;
-
-            conf_out.write(ack);
+            bool const mapped = apply_configuration(current_dma_message_read, false, map_updates_out, config_updates_out);
+            events.configuration_update = mapped;
+
+            if (current_dma_message_read.header.msg_type == InstrumentConfiguration::UpdateInstrumentDataCoalescedAck) {
+                // report the configuration in the coalesced ack of its instrument ids window
+                ap_uint<32> const instrument_id = current_dma_message_read.instrument_id;
+                ap_uint<32> const window_base = instrument_id & ~ap_uint<32>(coalesced_ack_window - 1);
+                uint64_t const instrument_bit = uint64_t(1) << instrument_id(5, 0);
+                bool const window_change = coalesced_ack_pending && current_coalesced_ack.base_instrument_id != window_base;
+                if (window_change)
+                    conf_out.write(pack_ack<2>(current_coalesced_ack, now)); // the instrument is out of the current window
+
+                if (! coalesced_ack_pending || window_change) {
+                    current_coalesced_ack.header.reserved = 0;
+                    current_coalesced_ack.header.error = 0;
+                    current_coalesced_ack.header.version = 1;
+                    current_coalesced_ack.header.source = enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration;
+                    current_coalesced_ack.header.msg_type = InstrumentConfiguration::UpdateInstrumentDataCoalescedAck;
+                    current_coalesced_ack.header.length = 0x0020; // sizeof(user_dma_update_instrument_configuration_coalesced_ack)
+                    current_coalesced_ack.base_instrument_id = window_base;
+                    current_coalesced_ack.applied_count = 0;
+                    current_coalesced_ack.rejected_count = 0;
+                    current_coalesced_ack.applied_bitmap = 0;
+                    current_coalesced_ack.rejected_bitmap = 0;
+                }
+                if (mapped) {
+                    ++current_coalesced_ack.applied_count;
+                    current_coalesced_ack.applied_bitmap |= instrument_bit;
+                } else {
+                    ++current_coalesced_ack.rejected_count;
+                    current_coalesced_ack.rejected_bitmap |= instrument_bit;
+                    current_coalesced_ack.header.error = 1;
+                }
+                coalesced_ack_pending = true;
+
+                if (current_dma_message_read.header.ack_request) {
+                    if (window_change) {
+                        coalesced_ack_flush = true; // conf_out already written this cycle
+                    } else {
+                        conf_out.write(pack_ack<2>(current_coalesced_ack, now));
+                        coalesced_ack_pending = false;
+                    }
+                }
+            } else if (current_dma_message_read.header.ack_request) {
+                user_dma_update_instrument_configuration_ack ack;
+                //header
+                ack.header.reserved = 0;
+                ack.header.error = !mapped; // configuration not applied
+                ack.header.version = 1;
+                ack.header.source = enyx::oe::nxaccess_hw_algo::InstrumentDataConfiguration;
+                ack.header.msg_type = InstrumentConfiguration::UpdateInstrumentData; // only notifications
+                ack.header.length = 0x0030; // force length value since sizeof yield incorrect value because vivado (as of 2018.3) has trouble with packed structure
+                //ack.header.length = sizeof(user_dma_update_instrument_configuration_ack); //unused here, shall be needed for retrocompat'. We put here a dump value.
+                //applicative layer 
+                ack.instrument_id = current_dma_message_read.instrument_id;
+                ack.enabled = current_dma_message_read.enabled;
+                ack.tick_to_cancel_collection_id = current_dma_message_read.tick_to_cancel_collection_id;
+                ack.tick_to_cancel_threshold = current_dma_message_read.tick_to_cancel_threshold;
+                ack.tick_to_trade_ask_collection_id = current_dma_message_read.tick_to_trade_ask_collection_id;
+                ack.tick_to_trade_ask_price = current_dma_message_read.tick_to_trade_ask_price;
+                ack.tick_to_trade_bid_collection_id = current_dma_message_read.tick_to_trade_bid_collection_id;
+                ack.tick_to_trade_bid_price = current_dma_message_read.tick_to_trade_bid_price;
+
+                conf_out.write(pack_ack<3>(ack, now));
+            }
 
             current_state = IDLE;
         }
         break;
     }
+    case READ_BATCH_RECORD_WORD1:
+    case READ_BATCH_RECORD_WORD2: {
+        if(!conf_in.empty()) {
+            enyx::hfp::dma_user_channel_data_in _read = conf_in.read();
+            if (current_state == READ_BATCH_RECORD_WORD1) {
+                read_word(current_dma_message_read, _read, 1); // header field is unused in records
+                current_state = READ_BATCH_RECORD_WORD2;
+            } else {
+                read_word(current_dma_message_read, _read, 2);
+                current_state = READ_BATCH_RECORD_WORD3;
+            }
+            if (_read.last == 1) { // truncated packet, the record is dropped
+                std::cout << "[WARNING][CONF] Configuration batch message truncated, "
+                          << std::dec << batch_records_left << " records missing.\n";
+                current_batch_ack.header.error = 1;
+                if (current_batch_read.header.ack_request)
+                    conf_out.write(pack_ack<1>(current_batch_ack, now));
+                current_state = IDLE;
+            }
+        }
+        break;
+    }
+    case READ_BATCH_RECORD_WORD3: {
+        if(!conf_in.empty()) {
+            enyx::hfp::dma_user_channel_data_in _read = conf_in.read();
+            read_word(current_dma_message_read, _read, 3);
+            bool const mapped = apply_configuration(current_dma_message_read, current_batch_read.shadow_bank != 0,
+                                                    map_updates_out, config_updates_out);
+            events.configuration_update = mapped;
+            if (mapped) {
+                ++current_batch_ack.applied_count;
+            } else {
+                if (current_batch_ack.rejected_count == 0)
+                    current_batch_ack.first_rejected_instrument_id = current_dma_message_read.instrument_id;
+                ++current_batch_ack.rejected_count;
+            }
+            --batch_records_left;
+
+            if (batch_records_left == 0 || _read.last == 1) {
+                // end of batch, a single ack for all its records
+                current_batch_ack.header.error = (current_batch_ack.rejected_count != 0) || (batch_records_left != 0);
+                if (current_batch_read.header.ack_request)
+                    conf_out.write(pack_ack<1>(current_batch_ack, now));
+                current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+            } else {
+                current_state = READ_BATCH_RECORD_WORD1;
+            }
+        }
+        break;
+    }
     case READ_SW_TRIG_ARG1: {
         if(!conf_in.empty()) {
             std::cout << "[CONF] processing word 2 of software trigger message (first argument)\n";
@@ -522,11 +887,46 @@ InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp
                 arg2,
                 arg3,
                 arg4);
+            events.trigger = 1;
+            events.software_trigger = 1;
 
             current_state = IDLE;
         }
         break;
     }
+    case READ_SW_TRIG_COMPACT_ARG: {
+        if(!conf_in.empty()) {
+            enyx::hfp::dma_user_channel_data_in _read = conf_in.read();
+
+            // the word holds the first argument not received yet
+            ap_uint<3> arg_index = 0;
+            for (int i = 4; i >= 0; --i)
+                if (compact_trigger_args_left[i])
+                    arg_index = i;
+            compact_trigger_args[arg_index] = _read.data;
+            compact_trigger_args_left.clear(arg_index);
+            std::cout << "[CONF] processing argument " << std::dec << arg_index << " of compact software trigger message\n";
+
+            if (compact_trigger_args_left == 0) {
+                nxoe::trigger_collection_internal(
+                    output,
+                    current_software_trigger_message_read.collection_id, // Collection to Trigger
+                    ap_uint<5>(current_software_trigger_message_read.arg_bitmap),
+                    compact_trigger_args[0],
+                    compact_trigger_args[1],
+                    compact_trigger_args[2],
+                    compact_trigger_args[3],
+                    compact_trigger_args[4]);
+                events.trigger = 1;
+                events.software_trigger = 1;
+                current_state = _read.last == 1 ? IDLE : IGNORE_PACKET;
+            } else if (_read.last == 1) {
+                std::cout << "[WARNING][CONF] Truncated compact software trigger message, ignoring ! \n";
+                current_state = IDLE;
+            }
+        }
+        break;
+    }
     case IGNORE_PACKET: { /// goal of this step is to process an unknown packet and
                           /// let it through without parsing it
         if(!conf_in.empty()) {
@@ -537,15 +937,103 @@ InstrumentConfiguration::p_handle_instrument_configuration(hls::stream<enyx::hfp
                 current_state = IDLE;
             }
         }
-        for(int i = 0; i != 2; ++i) {
-            if(!req_in[i].empty()) {
-                req_out[i].write(values[req_in[i].read()]);
-            }
-        }
         break;
     }
     }
 
+    report_events(events_out, pending_events, events);
+}
+
+void
+InstrumentConfiguration::p_serve_instrument_configuration(hls::stream<instrument_configuration_update> & config_updates_in,
+                                                          hls::stream<read_instrument_data_request> (& req_in)[strategy_count],
+                                                          hls::stream<instrument_configuration_response> (& req_out)[strategy_count],
+                                                          hls::stream<instrument_configuration_update> & config_updates_out) {
+
+#pragma HLS INLINE recursive
+#pragma HLS PIPELINE enable_flush
+
+    /// Stores instruments configuration, one replica per client so that all the read requests
+    /// and an update are served on the same cycle. Each replica holds the active and the shadow banks.
+    /// The banks are separate memories, so that an update of the active bank is written to both
+    /// in one cycle.
+    static InstrumentConfiguration::instrument_configuration_data_item values[strategy_count][2][InstrumentConfiguration::instrument_count];
+#pragma HLS ARRAY_PARTITION variable=values complete dim=1
+#pragma HLS ARRAY_PARTITION variable=values complete dim=2
+#pragma HLS RESOURCE variable=values core=XPM_MEMORY uram latency=2
+    // the updates of the last cycles and of this one are forwarded to the reads
+#pragma HLS DEPENDENCE variable=values inter false
+
+    static ap_uint<1> active_bank = 0; /// bank read by the strategies
+#pragma HLS RESET variable=active_bank
+    static ap_uint<8> active_epoch = 0; /// epoch id of the active bank
+#pragma HLS RESET variable=active_epoch
+
+    /// updates of the last cycles, most recent first
+    static instrument_configuration_update recent_updates[enyx::uram_forward_depth];
+    static ap_uint<2> recent_updates_banks[enyx::uram_forward_depth]; /// banks written, a bit per bank
+#pragma HLS ARRAY_PARTITION variable=recent_updates complete dim=1
+#pragma HLS ARRAY_PARTITION variable=recent_updates_banks complete dim=1
+#pragma HLS RESET variable=recent_updates_banks
+
+    bool update_valid = false;
+    instrument_configuration_update update = instrument_configuration_update();
+    if(!config_updates_in.empty()) {
+        update = config_updates_in.read();
+        update_valid = true;
+    }
+
+    if (fused_instrument_state) { // strategies use the instrument state memory, no replica to serve
+        if(update_valid)
+            config_updates_out.write(update);
+        return;
+    }
+
+    bool const write_valid = update_valid && !update.commit;
+    bool const write_active = write_valid && !update.shadow; /// mirrored into the shadow bank
+    bool const write_shadow = write_valid;
+    ap_uint<1> const shadow_bank = active_bank ^ 1;
+    ap_uint<2> banks = 0; /// banks written, a bit per bank
+    if(write_active)
+        banks.set(active_bank);
+    if(write_shadow)
+        banks.set(shadow_bank);
+
+    // process read requests from read request bus, the banks are swapped after the reads of the commit cycle
+    for(int i = 0; i != strategy_count; ++i) {
+        if(!req_in[i].empty()) {
+            read_instrument_data_request const slot = req_in[i].read();
+            instrument_configuration_response output;
+            output.config = values[i][active_bank][slot];
+            for(int w = enyx::uram_forward_depth - 1; w >= 0; --w) // oldest first
+                if (recent_updates_banks[w][active_bank] && recent_updates[w].slot == slot)
+                    output.config = recent_updates[w].config;
+            if (write_active && update.slot == slot)
+                output.config = update.config;
+            output.epoch = active_epoch;
+            req_out[i].write(output);
+        }
+    }
+
+    for(int i = 0; i != strategy_count; ++i) {
+        if(write_active)
+            values[i][active_bank][update.slot] = update.config;
+        if(write_shadow)
+            values[i][shadow_bank][update.slot] = update.config;
+    }
+    for(int w = enyx::uram_forward_depth - 1; w != 0; --w) {
+        recent_updates[w] = recent_updates[w - 1];
+        recent_updates_banks[w] = recent_updates_banks[w - 1];
+    }
+    recent_updates[0] = update;
+    recent_updates_banks[0] = banks;
+    if(update_valid && update.commit) {
+        active_bank = ~active_bank;
+        active_epoch = update.epoch;
+        std::cout << "[CONF] Configuration epoch " << std::dec << int(update.epoch) << " active\n";
+    }
+    if(update_valid)
+        config_updates_out.write(update); // let the instrument state memory know about it
 }
 
 }
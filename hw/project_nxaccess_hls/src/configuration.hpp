@@ -18,6 +18,7 @@
 #include <hls_stream.h>
 
 #include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/hls/clock.hpp"
 
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
 #include "../include/enyx/oe/hwstrat/msg_headers.hpp"
@@ -25,6 +26,9 @@
 
 
 #include "messages.hpp"
+#include "parameters.hpp"
+#include "notification_payload.hpp"
+#include "module_events.hpp"
 #include "../include/enyx/hfp/hfp.hpp"
 
 namespace nxmd = enyx::md::hw;
@@ -40,13 +44,25 @@ using namespace enyx::hfp;
 class InstrumentConfiguration
 {
   public:
-    typedef uint32_t read_instrument_data_request ; /// read instrument data request in memory
-    static std::size_t const instrument_count = 256;
+    typedef uint32_t read_instrument_data_request ; /// read instrument data request in memory, by instrument slot
+    static std::size_t const instrument_count = enyx::oe::nxaccess_hw_algo::instrument_count;
+    static std::size_t const coalesced_ack_window = 64; /// instrument ids reported by a coalesced ack
 
     static enum {
         UpdateInstrumentData = 1, // Update Instrument data
+        UpdateInstrumentDataBatch = 2, // Update the data of a batch of instruments, with a single summary ack
+        UpdateInstrumentDataCoalescedAck = 3, // Update Instrument data, the ack being coalesced with the next ones
+        CommitConfigurationEpoch = 4, // Swap the active & shadow configuration banks
+        ReadLatencyHistogram = 5, // Send the trigger latency histogram of a module, answered by the statistics
+        ReadNotificationsStatus = 6, // Send a notifications status, answered by the notifications monitor
+        ReadStatistics = 7, // Send the statistics counters, answered by the statistics
     } messages_types;
 
+    static enum {
+        SoftwareTriggerWithArgs = 1, // Trigger with the 5 arguments, whatever arg_bitmap
+        SoftwareTriggerCompact = 2, // Trigger with only the arguments set in arg_bitmap
+    } software_trigger_messages_types;
+
     /// memory structure used for storing instrument configuration
     /// layout of the packet sent by software to FPGA
     /// see messages.hpp for message layout reference
@@ -64,26 +80,85 @@ class InstrumentConfiguration
         ap_uint<nxoe::trigger_meta_size::TRIGGER_SIZE_COLLECTION_ID> tick_to_trade_ask_collection_id;
     }; // 241 bits wide
 
+    /// configuration read by the strategies, with the epoch of the active bank: the epoch is
+    /// held by the memory servers, not stored in the memories
+    struct instrument_configuration_response {
+        instrument_configuration_data_item config;
+        ap_uint<8> epoch; // epoch of the active bank
+    };
+
+    /// instrument configuration update, sent to the memories caching the configuration
+    /// The memories hold two banks, the strategies read the active one. An epoch commit swaps the
+    /// banks, all the memories applying it in the order of the updates.
+    /// An update of the active bank is mirrored into the shadow bank, so that the next commit keeps
+    /// it: it replaces the configuration staged in the shadow bank for its instrument.
+    struct instrument_configuration_update {
+        ap_uint<32> slot; // instrument slot
+        instrument_configuration_data_item config;
+        ap_uint<1> shadow; // written to the shadow bank instead of the active one
+        ap_uint<1> commit; // epoch commit: swaps the banks, slot & config are unused
+        ap_uint<8> epoch; // epoch commit: id of the new epoch
+    };
+
 
     InstrumentConfiguration() {}
 
-    /// Read messages from DMA and store configuration into memory, provide feedback message to DMA
-    /// and answers read request to decision blocks
+    /// Read messages from DMA, parse configuration updates and software triggers, provide feedback
+    /// message to DMA.
+    /// Configurations are stored by instrument slot: a slot is allocated to each newly configured
+    /// instrument, and the map update is sent to the nxbus instrument mapper.
+    /// Each configuration update is sent to the configuration memory server.
+    /// Batches of configurations are parsed one word per cycle, and acknowledged by a single
+    /// summary message.
+    /// Acks are only sent when requested (ack_request). The acks of UpdateInstrumentDataCoalescedAck
+    /// messages are merged in a bitmap of coalesced_ack_window instrument ids, sent when an
+    /// instrument out of the window is configured or when the ack is requested: there is no timeout,
+    /// the ack of the last window is held until a configuration requests it.
+    /// Batches may be written to the shadow configuration bank, made active by an epoch commit.
+    /// Software triggers are issued on the last word received: compact triggers take a DMA word
+    /// per argument present only.
+    /// Latency histogram & counters requests are forwarded to the statistics, which answer them,
+    /// and notifications status requests to the notifications monitor.
+    /// The acks are never dropped: the process waits for room in conf_out, delaying the software
+    /// triggers which follow when the DMA egress is slow.
     static void
     p_handle_instrument_configuration(hls::stream<enyx::hfp::dma_user_channel_data_in> & conf_in,
-                                               hls::stream<read_instrument_data_request> (& req_in)[2],
-                                               hls::stream<instrument_configuration_data_item> (& req_out)[2],
-                                               hls::stream<user_dma_update_instrument_configuration_ack> & conf_out,
-                                               hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output);
-
+                                               hls::stream<notification_payload> & conf_out,
+                                               hls::stream<module_events_counts> & events_out,
+                                               hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output,
+                                               hls::stream<InstrumentMap::map_update> & map_updates_out,
+                                               hls::stream<instrument_configuration_update> & config_updates_out,
+                                               hls::stream<latency_histogram_request> & histogram_requests_out,
+                                               hls::stream<statistics_request> & statistics_requests_out,
+                                               hls::stream<notifications_status_request> & status_requests_out,
+                                               enyx::hls_tools::cycle_count now);
+
+    /// Store configuration updates into memory and answers read requests to decision blocks,
+    /// every cycle whatever the DMA parser is doing. The updates are then forwarded to the
+    /// instrument state memory (see InstrumentState).
+    /// The memory holds the active and shadow banks, swapped in one cycle by an epoch commit.
+    /// The updates of the active bank are written to both banks.
+    /// With fused_instrument_state, the strategies read the instrument state memory: the updates
+    /// are only forwarded, the replicas being left out.
+    static void
+    p_serve_instrument_configuration(hls::stream<instrument_configuration_update> & config_updates_in,
+                                     hls::stream<read_instrument_data_request> (& req_in)[strategy_count],
+                                     hls::stream<instrument_configuration_response> (& req_out)[strategy_count],
+                                     hls::stream<instrument_configuration_update> & config_updates_out);
 
     static void write_word(const user_dma_update_instrument_configuration& in, enyx::hfp::dma_user_channel_data_out& word,  int word_index);
     static void write_word(const user_dma_update_instrument_configuration_ack& in, enyx::hfp::dma_user_channel_data_out& word, int word_index);
     static void write_word(const user_dma_software_trigger_message& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index);
+    static void write_word(const user_dma_update_instrument_configuration_batch_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index);
+    static void write_word(const user_dma_update_instrument_configuration_coalesced_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index);
+    static void write_word(const user_dma_commit_configuration_epoch_ack& in, enyx::hfp::dma_user_channel_data_out& out_word, int word_index);
 
     static void read_word(user_dma_update_instrument_configuration& ret, const enyx::hfp::dma_user_channel_data_in& word, int word_index);
     static void read_word(user_dma_update_instrument_configuration_ack& ret, const enyx::hfp::dma_user_channel_data_in& word,  int word_index);
     static void read_word(user_dma_software_trigger_message& ret, const enyx::hfp::dma_user_channel_data_in& word,  int word_index);
+    static void read_word(user_dma_update_instrument_configuration_batch& ret, const enyx::hfp::dma_user_channel_data_in& word,  int word_index);
+    static void read_word(user_dma_commit_configuration_epoch& ret, const enyx::hfp::dma_user_channel_data_in& word,  int word_index);
+    static void read_word(user_dma_read_latency_histogram& ret, const enyx::hfp::dma_user_channel_data_in& word,  int word_index);
 
 
 };
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#include <iostream>
+
+#include "instrument_state.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+InstrumentState::trigger_level
+InstrumentState::tick_to_cancel_level(InstrumentConfiguration::instrument_configuration_data_item const& config,
+                                      Books::halfbook_entry const& top, ap_uint<1> const& side)
+{
+    #pragma HLS INLINE
+    // the levels out of the price range can't be reached by a trade price
+    ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE + 1> const ask_level = ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE + 1>(top.price) + config.tick_to_cancel_threshold;
+    bool const in_range = side == 1 ? top.price >= config.tick_to_cancel_threshold
+                                    : ask_level[nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE] == 0;
+    trigger_level ret;
+    ret.armed = top.present && config.enabled && config.tick_to_cancel_threshold != 0 && in_range;
+    ret.price = side == 1 ? ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE>(top.price - config.tick_to_cancel_threshold)
+                          : ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE>(ask_level);
+    return ret;
+}
+
+void
+InstrumentState::p_serve(hls::stream<InstrumentConfiguration::instrument_configuration_update> & config_updates_in,
+                         hls::stream<Books::top_of_book_update> & top_of_book_updates_in,
+                         hls::stream<read_instrument_state_request> (& req_in)[book_client_count],
+                         hls::stream<state_entry> (& req_out)[book_client_count])
+{
+    #pragma HLS INLINE recursive
+    #pragma HLS PIPELINE enable_flush
+
+    /// Stores instruments state, one replica per client, replica book_client_count is the master copy
+    /// read to compute the trigger levels. Configuration, top levels and trigger levels are separate
+    /// memories read at the same address, each one updated on its own write port.
+    /// Configurations & trigger levels have an active and a shadow bank, swapped by an epoch commit.
+    static InstrumentConfiguration::instrument_configuration_data_item configs[book_client_count + 1][2][instrument_count];
+    static Books::halfbook_entry tops[book_client_count + 1][2][instrument_count]; // [client][0][x] is Sell side, [client][1][x] is Buy side
+    static trigger_level levels[book_client_count][2][2][instrument_count]; // [client][bank][side][x]
+    #pragma HLS ARRAY_PARTITION variable=configs complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=configs complete dim=2
+    #pragma HLS ARRAY_PARTITION variable=tops complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=tops complete dim=2
+    #pragma HLS ARRAY_PARTITION variable=levels complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=levels complete dim=2
+    #pragma HLS ARRAY_PARTITION variable=levels complete dim=3
+    #pragma HLS RESOURCE variable=configs core=XPM_MEMORY uram latency=2
+    #pragma HLS RESOURCE variable=tops core=XPM_MEMORY uram latency=2
+    #pragma HLS RESOURCE variable=levels core=XPM_MEMORY uram latency=2
+    // the updates of the last cycles and of this one are forwarded to the reads
+    #pragma HLS DEPENDENCE variable=configs inter false
+    #pragma HLS DEPENDENCE variable=tops inter false
+    #pragma HLS DEPENDENCE variable=levels inter false
+
+    static ap_uint<1> active_bank = 0; /// bank read by the strategies
+    #pragma HLS RESET variable=active_bank
+    static ap_uint<8> active_epoch = 0; /// epoch id of the active bank
+    #pragma HLS RESET variable=active_epoch
+
+    /// updates of the last cycles, most recent first, forwarded to the reads
+    static InstrumentConfiguration::instrument_configuration_update recent_configs[enyx::uram_forward_depth];
+    static ap_uint<2> recent_configs_banks[enyx::uram_forward_depth]; /// banks written, a bit per bank
+    static ap_uint<1> recent_configs_valid[enyx::uram_forward_depth];
+    static Books::top_of_book_update recent_tops[enyx::uram_forward_depth];
+    static ap_uint<1> recent_tops_valid[enyx::uram_forward_depth];
+    static ap_uint<32> recent_levels_slot[enyx::uram_forward_depth];
+    static trigger_level recent_levels[enyx::uram_forward_depth][2][2]; // [write][bank][side]
+    static ap_uint<2> recent_levels_banks[enyx::uram_forward_depth]; /// banks written, a bit per bank
+    static ap_uint<2> recent_levels_sides[enyx::uram_forward_depth]; /// sides written, a bit per side
+    #pragma HLS ARRAY_PARTITION variable=recent_configs complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_configs_banks complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_configs_valid complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_tops complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_tops_valid complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_levels_slot complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_levels complete dim=0
+    #pragma HLS ARRAY_PARTITION variable=recent_levels_banks complete dim=1
+    #pragma HLS ARRAY_PARTITION variable=recent_levels_sides complete dim=1
+    #pragma HLS RESET variable=recent_configs_valid
+    #pragma HLS RESET variable=recent_tops_valid
+    #pragma HLS RESET variable=recent_levels_banks
+
+    // one update per cycle, so that each memory has a single write: configuration updates are rare
+    // and go first, the top of book update then waits one cycle
+    bool config_valid = false;
+    bool commit_valid = false;
+    InstrumentConfiguration::instrument_configuration_update config = InstrumentConfiguration::instrument_configuration_update();
+    bool top_valid = false;
+    Books::top_of_book_update top = Books::top_of_book_update();
+    if (! config_updates_in.empty()) {
+        config = config_updates_in.read();
+        commit_valid = config.commit;
+        config_valid = ! config.commit;
+    } else if (! top_of_book_updates_in.empty()) {
+        top = top_of_book_updates_in.read();
+        top_valid = true;
+    }
+
+    if (! fused_instrument_state) // strategies use the configuration & books memories
+        return;
+
+    // an update of the active bank is mirrored into the shadow bank
+    ap_uint<2> config_banks = 0; /// banks written, a bit per bank
+    if (config_valid) {
+        config_banks.set(active_bank ^ 1);
+        if (! config.shadow)
+            config_banks.set(active_bank);
+    }
+
+    // compute the trigger levels of the updated instrument from the master copy, for both banks
+    ap_uint<32> const slot_updated = config_valid ? config.slot : top.book_index;
+    InstrumentConfiguration::instrument_configuration_data_item slot_configs[2];
+    slot_configs[0] = configs[book_client_count][0][slot_updated];
+    slot_configs[1] = configs[book_client_count][1][slot_updated];
+    Books::halfbook_entry slot_tops[2];
+    slot_tops[0] = tops[book_client_count][0][slot_updated];
+    slot_tops[1] = tops[book_client_count][1][slot_updated];
+    for (int w = enyx::uram_forward_depth - 1; w >= 0; --w) { // oldest first
+        for (int bank = 0; bank != 2; ++bank)
+            if (recent_configs_valid[w] && recent_configs_banks[w][bank] && recent_configs[w].slot == slot_updated)
+                slot_configs[bank] = recent_configs[w].config;
+        if (recent_tops_valid[w] && recent_tops[w].book_index == slot_updated)
+            slot_tops[recent_tops[w].side] = recent_tops[w].top;
+    }
+    for (int bank = 0; bank != 2; ++bank)
+        if (config_banks[bank])
+            slot_configs[bank] = config.config;
+    if (top_valid)
+        slot_tops[top.side] = top.top;
+
+    trigger_level slot_levels[2][2]; // [bank][side]
+    ap_uint<2> levels_banks = 0; /// banks written, a bit per bank
+    for (int bank = 0; bank != 2; ++bank) {
+        slot_levels[bank][0] = tick_to_cancel_level(slot_configs[bank], slot_tops[0], 0);
+        slot_levels[bank][1] = tick_to_cancel_level(slot_configs[bank], slot_tops[1], 1);
+        levels_banks.set_bit(bank, precomputed_trigger_levels && (config_banks[bank] || top_valid));
+    }
+    ap_uint<2> levels_sides = 0; /// sides written, a bit per side
+    levels_sides.set_bit(0, config_valid || top.side == 0);
+    levels_sides.set_bit(1, config_valid || top.side == 1);
+
+    // the banks are swapped after the reads of the commit cycle
+    for (int i = 0; i != book_client_count; ++i) {
+        if (! req_in[i].empty()) {
+            read_instrument_state_request const slot = req_in[i].read();
+            state_entry output;
+            output.config = configs[i][active_bank][slot];
+            output.ask = tops[i][0][slot];
+            output.bid = tops[i][1][slot];
+            output.tick_to_cancel_ask = levels[i][active_bank][0][slot];
+            output.tick_to_cancel_bid = levels[i][active_bank][1][slot];
+
+            // forward the updates of the last cycles, then the one of this cycle
+            for (int w = enyx::uram_forward_depth - 1; w >= 0; --w) { // oldest first
+                if (recent_configs_valid[w] && recent_configs_banks[w][active_bank] && recent_configs[w].slot == slot)
+                    output.config = recent_configs[w].config;
+                if (recent_tops_valid[w] && recent_tops[w].book_index == slot) {
+                    if (recent_tops[w].side == 1)
+                        output.bid = recent_tops[w].top;
+                    else
+                        output.ask = recent_tops[w].top;
+                }
+                if (recent_levels_banks[w][active_bank] && recent_levels_slot[w] == slot) {
+                    if (recent_levels_sides[w][0])
+                        output.tick_to_cancel_ask = recent_levels[w][active_bank][0];
+                    if (recent_levels_sides[w][1])
+                        output.tick_to_cancel_bid = recent_levels[w][active_bank][1];
+                }
+            }
+            if (config_banks[active_bank] && config.slot == slot)
+                output.config = config.config;
+            if (top_valid && top.book_index == slot) {
+                if (top.side == 1)
+                    output.bid = top.top;
+                else
+                    output.ask = top.top;
+            }
+            if (levels_banks[active_bank] && slot_updated == slot) {
+                if (levels_sides[0])
+                    output.tick_to_cancel_ask = slot_levels[active_bank][0];
+                if (levels_sides[1])
+                    output.tick_to_cancel_bid = slot_levels[active_bank][1];
+            }
+            output.epoch = active_epoch;
+            req_out[i].write(output);
+        }
+    }
+
+    // update every replica
+    for (int i = 0; i != book_client_count + 1; ++i) {
+        for (int bank = 0; bank != 2; ++bank)
+            if (config_banks[bank])
+                configs[i][bank][config.slot] = config.config;
+        if (top_valid)
+            tops[i][top.side][top.book_index] = top.top;
+    }
+    for (int i = 0; i != book_client_count; ++i) {
+        for (int bank = 0; bank != 2; ++bank) {
+            if (levels_banks[bank] && levels_sides[0])
+                levels[i][bank][0][slot_updated] = slot_levels[bank][0];
+            if (levels_banks[bank] && levels_sides[1])
+                levels[i][bank][1][slot_updated] = slot_levels[bank][1];
+        }
+    }
+    if (commit_valid) {
+        active_bank = ~active_bank;
+        active_epoch = config.epoch;
+    }
+
+    for (int w = enyx::uram_forward_depth - 1; w != 0; --w) {
+        recent_configs[w] = recent_configs[w - 1];
+        recent_configs_banks[w] = recent_configs_banks[w - 1];
+        recent_configs_valid[w] = recent_configs_valid[w - 1];
+        recent_tops[w] = recent_tops[w - 1];
+        recent_tops_valid[w] = recent_tops_valid[w - 1];
+        recent_levels_slot[w] = recent_levels_slot[w - 1];
+        recent_levels_banks[w] = recent_levels_banks[w - 1];
+        recent_levels_sides[w] = recent_levels_sides[w - 1];
+        for (int bank = 0; bank != 2; ++bank)
+            for (int side = 0; side != 2; ++side)
+                recent_levels[w][bank][side] = recent_levels[w - 1][bank][side];
+    }
+    recent_configs[0] = config;
+    recent_configs_banks[0] = config_banks;
+    recent_configs_valid[0] = config_valid;
+    recent_tops[0] = top;
+    recent_tops_valid[0] = top_valid;
+    recent_levels_slot[0] = slot_updated;
+    recent_levels_banks[0] = levels_banks;
+    recent_levels_sides[0] = levels_sides;
+    for (int bank = 0; bank != 2; ++bank)
+        for (int side = 0; side != 2; ++side)
+            recent_levels[0][bank][side] = slot_levels[bank][side];
+} // p_serve
+
+}}} // Namespaces
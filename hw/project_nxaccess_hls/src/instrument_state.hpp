@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "../include/enyx/md/hw/books.hpp"
+#include "parameters.hpp"
+#include "configuration.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/**
+ * @brief Unified instrument state memory: the instrument configuration and the top of book,
+ * stored side by side and read at the same address, so that a strategy gets everything it needs
+ * from one read port with one memory latency.
+ * The configuration and top of book updates are sent by InstrumentConfiguration and Books, which
+ * then leave out their per strategy replicas. Enabled with fused_instrument_state (see parameters.hpp).
+ *
+ * With precomputed_trigger_levels, the tick to cancel trigger levels (top level price -/+ threshold)
+ * are also computed when a configuration or a top of book update arrives, so that the decision
+ * is a single compare.
+ *
+ * Configurations and trigger levels follow the active/shadow banks of the configuration memory,
+ * the top of book updates refreshing the trigger levels of both banks. As there, the updates of
+ * the active bank are mirrored into the shadow bank.
+ */
+class InstrumentState {
+public:
+    typedef uint32_t read_instrument_state_request; /// read instrument state request in memory, by instrument slot
+
+    /// trigger level derived from the configuration and the top of book
+    struct trigger_level {
+        ap_uint<1> armed; // top level present, configuration enabled and threshold set
+        ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_PRICE> price;
+    };
+
+    /// state of an instrument, as read by the strategies
+    struct state_entry {
+        InstrumentConfiguration::instrument_configuration_data_item config;
+        ap_uint<8> epoch; // epoch of the active configuration bank
+        Books::halfbook_entry bid; // book top level, buy side
+        Books::halfbook_entry ask; // book top level, sell side
+        trigger_level tick_to_cancel_bid; // bid top level price - tick to cancel threshold (precomputed_trigger_levels)
+        trigger_level tick_to_cancel_ask; // ask top level price + tick to cancel threshold (precomputed_trigger_levels)
+    };
+
+    /**
+     * @brief InstrumentState::p_serve Apply configuration & top of book updates, answer the
+     * strategies read requests. Drains the updates when the fused memory is disabled.
+     */
+    static void
+    p_serve(hls::stream<InstrumentConfiguration::instrument_configuration_update> & config_updates_in,
+            hls::stream<Books::top_of_book_update> & top_of_book_updates_in,
+            hls::stream<read_instrument_state_request> (& req_in)[book_client_count],
+            hls::stream<state_entry> (& req_out)[book_client_count]);
+
+    /// Computes the tick to cancel trigger level of a book side
+    static trigger_level
+    tick_to_cancel_level(InstrumentConfiguration::instrument_configuration_data_item const& config,
+                         Books::halfbook_entry const& top, ap_uint<1> const& side);
+}; // class
+}}} // Namespaces
@@ -81,6 +81,211 @@ struct user_dma_update_instrument_configuration_ack {
 
 
 
+/// Header of a batch of instrument configurations, for CPU->FPGA comm
+/// It is followed in the same packet by record_count records, each one laid out as the
+/// 3 words of user_dma_update_instrument_configuration, the header field being unused.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_update_instrument_configuration_batch {
+    // word 1
+    struct enyx::oe::hwstrat::cpu2fpga_header header; // 64 bits
+    uint16_t record_count; // count of configuration records in the packet
+    uint8_t shadow_bank; // 1: records are written to the shadow configuration bank, see user_dma_commit_configuration_epoch
+    char pad[5]; //ensure aligned on 128bits words
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(16 == sizeof(user_dma_update_instrument_configuration_batch), "Size of user_dma_update_instrument_configuration_batch is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(16 == sizeof(user_dma_update_instrument_configuration_batch), "Size of user_dma_update_instrument_configuration_batch is invalid");
+   # endif
+# endif
+
+
+/// Summary ack of a batch of instrument configurations, for FPGA->CPU comm
+/// The error bit of the header is set when a record is rejected or the packet is truncated.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_update_instrument_configuration_batch_ack {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 2, length == 16
+    uint16_t applied_count; // count of configurations applied
+    uint16_t rejected_count; // count of configurations rejected (no instrument slot available)
+    uint32_t first_rejected_instrument_id; // instrument id of the first rejected configuration, if any
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(16 == sizeof(user_dma_update_instrument_configuration_batch_ack), "Size of user_dma_update_instrument_configuration_batch_ack is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(16 == sizeof(user_dma_update_instrument_configuration_batch_ack), "Size of user_dma_update_instrument_configuration_batch_ack is invalid");
+   # endif
+# endif
+
+
+
+/// Coalesced ack of instrument configurations, for FPGA->CPU comm
+/// Reports the configurations applied/rejected for the 64 instrument ids starting at base_instrument_id.
+/// The error bit of the header is set when a configuration is rejected.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_update_instrument_configuration_coalesced_ack {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 3, length == 32
+    uint32_t base_instrument_id; // instrument id of bit 0 of the bitmaps, multiple of 64
+    uint16_t applied_count; // count of configurations applied
+    uint16_t rejected_count; // count of configurations rejected (no instrument slot available)
+    //16B
+    uint64_t applied_bitmap; // bit i set: configuration of instrument base_instrument_id + i applied
+    uint64_t rejected_bitmap; // bit i set: configuration of instrument base_instrument_id + i rejected
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(32 == sizeof(user_dma_update_instrument_configuration_coalesced_ack), "Size of user_dma_update_instrument_configuration_coalesced_ack is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(32 == sizeof(user_dma_update_instrument_configuration_coalesced_ack), "Size of user_dma_update_instrument_configuration_coalesced_ack is invalid");
+   # endif
+# endif
+
+
+
+/// Swaps the active and shadow configuration banks, for CPU->FPGA comm
+/// The strategies use the configurations of the former shadow bank from the next cycle, and report
+/// the epoch id in their notifications. The shadow bank then holds the configurations of the previous epoch.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_commit_configuration_epoch {
+    //16B
+    struct enyx::oe::hwstrat::cpu2fpga_header header; // 64 bits
+    uint8_t epoch; // id of the new epoch, chosen by software
+    char pad[7]; //ensure aligned on 128bits words
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(16 == sizeof(user_dma_commit_configuration_epoch), "Size of user_dma_commit_configuration_epoch is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(16 == sizeof(user_dma_commit_configuration_epoch), "Size of user_dma_commit_configuration_epoch is invalid");
+   # endif
+# endif
+
+
+/// Ack of a configuration epoch commit, for FPGA->CPU comm
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_commit_configuration_epoch_ack {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 4, length == 16
+    uint8_t epoch; // id of the active epoch
+    char padding[7]; //ensure aligned on 128bits words
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(16 == sizeof(user_dma_commit_configuration_epoch_ack), "Size of user_dma_commit_configuration_epoch_ack is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(16 == sizeof(user_dma_commit_configuration_epoch_ack), "Size of user_dma_commit_configuration_epoch_ack is invalid");
+   # endif
+# endif
+
+/// Requests the trigger latency histogram of a module, for CPU->FPGA comm
+/// The histogram is sent by the statistics (see user_dma_latency_histogram), and optionally reset.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_read_latency_histogram {
+    //16B
+    struct enyx::oe::hwstrat::cpu2fpga_header header; // 64 bits
+    uint8_t module; // statistics module: the strategies in registry order, then the configuration & the TCP consumer
+    uint8_t reset; // reset the histogram once read
+    char pad[6]; //ensure aligned on 128bits words
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(16 == sizeof(user_dma_read_latency_histogram), "Size of user_dma_read_latency_histogram is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(16 == sizeof(user_dma_read_latency_histogram), "Size of user_dma_read_latency_histogram is invalid");
+   # endif
+# endif
+
+
+/// Periodic status of the notifications, for FPGA->CPU comm
+/// The notification buses are the strategies in registry order, then the configuration acks,
+/// the TCP consumer, the statistics and this status (see notifications.hpp).
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_notifications_status {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 1, length == 48
+    uint32_t sequence_number; // status messages emitted since reset
+    uint8_t bus_count; // notification buses reported in dropped
+    char padding[3]; //ensure aligned on 128bits words
+    //32B
+    uint32_t dropped[8]; // notifications dropped since reset per notification bus, wrapping
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(48 == sizeof(user_dma_notifications_status), "Size of user_dma_notifications_status is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(48 == sizeof(user_dma_notifications_status), "Size of user_dma_notifications_status is invalid");
+   # endif
+# endif
+
+/// A page of the statistics counters, for FPGA->CPU comm
+/// Each statistics period, the counters are sent in page_count messages of 8 counters, one page
+/// per cycle, the header timestamp giving the cycle at which the page was read.
+/// See Statistics for the counters of each page.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_statistics {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 1, length == 48
+    uint32_t sequence_number; // statistics periods elapsed since reset
+    uint16_t page; // index of the page
+    uint16_t page_count; // pages sent each period
+    //32B
+    uint32_t counters[8]; // counters since reset, wrapping
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(48 == sizeof(user_dma_statistics), "Size of user_dma_statistics is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(48 == sizeof(user_dma_statistics), "Size of user_dma_statistics is invalid");
+   # endif
+# endif
+
+/// A page of a trigger latency histogram, for FPGA->CPU comm
+/// Answer to user_dma_read_latency_histogram: the histogram is sent in page_count messages of
+/// 8 buckets, one page per cycle. Bucket i counts the triggers issued i * bucket_width to
+/// (i + 1) * bucket_width - 1 cycles after their market data, the last bucket the longer ones.
+/// The error bit is set, and a single page sent, for an unknown module.
+#ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
+    #pragma pack(1)
+#endif
+struct user_dma_latency_histogram {
+    //16B
+    struct enyx::oe::hwstrat::fpga2cpu_header header; //version == 1, msgtype == 2, length == 48
+    uint8_t module; // statistics module of the histogram
+    uint8_t reset; // the histogram was reset once read
+    uint16_t bucket_width; // cycles per bucket
+    uint16_t page; // index of the page
+    uint16_t page_count; // pages of the histogram
+    //32B
+    uint32_t buckets[8]; // triggers since reset, wrapping
+};
+#  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
+  static_assert(48 == sizeof(user_dma_latency_histogram), "Size of user_dma_latency_histogram is invalid");
+# else
+   # if __GNUC_MAJOR__ >= 4 // only available on GCC 4.6+. What about clang ?
+     _Static_assert(48 == sizeof(user_dma_latency_histogram), "Size of user_dma_latency_histogram is invalid");
+   # endif
+# endif
+
+
 /// Complete message layout to configure an instrument trigger, for FPGA->CPU comm
 #ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
     #pragma pack(1)
@@ -96,7 +301,9 @@ struct user_dma_tick2cancel_notification {
     uint32_t instrument_id; /// instrument id to trigger on
     uint16_t sent_collection_id; // triggered collection id
     uint8_t is_bid; /// Whether the configuration fot this instrument is enabled or not.
-    char padding[9]; // pad to ensure 128b 
+    uint8_t epoch; /// configuration epoch which triggered
+    uint32_t nxbus_arrival; /// cycle at which the trade summary reached the strategy, header.timestamp being the trigger cycle
+    char padding[4]; // pad to ensure 128b 
 };
 #  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
   static_assert(48 == sizeof(user_dma_update_instrument_configuration_ack), "Size of user_dma_update_instrument_configuration is invalid");
@@ -143,8 +350,10 @@ struct user_dma_tick2trade_notification {
     uint32_t instrument_id; /// instrument id to trigger on
     uint16_t sent_collection_id; // triggered collection id  
     uint8_t is_bid; /// Whether the configuration fot this instrument is enabled or not.
-    char padding[1]; //ensure aligned on 128bits words
-
+    uint8_t epoch; /// configuration epoch which triggered
+    //16B
+    uint32_t nxbus_arrival; /// cycle at which the trade summary reached the strategy, header.timestamp being the trigger cycle
+    char padding[12]; // pad to ensure 128b
 };
 #  if __GNUC_MAJOR__ >= 5  // introduced with C++11 standard
   static_assert(32 == sizeof(user_dma_update_instrument_configuration_ack), "Size of user_dma_update_instrument_configuration is invalid");
@@ -156,6 +365,8 @@ struct user_dma_tick2trade_notification {
 
 
 /// Software initiated trigger with arguments message
+/// With msg_type SoftwareTriggerCompact, only the arguments set in arg_bitmap are sent, in
+/// increasing argument index order: the message is 16B + 16B per argument present.
 #ifdef ENYX_NO_HLS_SUPPORT // do not use #pragma pack() with Vivado
     #pragma pack(1)
 #endif
@@ -187,7 +398,9 @@ enum fpga_modules_ids {
     InstrumentDataConfiguration = 8, // Module that handle instrument configuration, see configuration.hpp
     SoftwareTrigger = 9, // Not implemented yet, reserved for module handling trigger from software. // Not present in demonstration
     Tick2cancel = 10,   // tick2cancel strategy
-    Tick2trade = 11 // tick2trade strategy
+    Tick2trade = 11, // tick2trade strategy
+    NotificationsStatus = 12, // notifications monitor, see notifications.hpp
+    StatisticsCounters = 13 // statistics, see statistics.hpp
 }; // application specific definition of module ids.
 
 }
@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "parameters.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/// modules reporting their events to the statistics: one per strategy, then the configuration
+/// and the TCP consumer
+static const std::size_t statistics_module_count = strategy_count + 2;
+static const std::size_t statistics_module_configuration = strategy_count;
+static const std::size_t statistics_module_tcp_consumer = strategy_count + 1;
+
+/// Events of a module in a cycle, counted by the statistics (see Statistics)
+struct module_events {
+    ap_uint<1> trigger;              /// a trigger command was written
+    ap_uint<1> decision_full;        /// the trigger commands FIFO was full
+    ap_uint<1> notification_full;    /// the notifications FIFO was full
+    ap_uint<1> configuration_update; /// an instrument configuration was applied
+    ap_uint<1> software_trigger;     /// a software trigger was issued
+    ap_uint<32> trigger_latency;     /// cycles from the first nxbus word (or TCP word) to the trigger,
+                                     /// when trigger is set by a market data driven trigger
+
+    module_events()
+        : trigger(0), decision_full(0), notification_full(0), configuration_update(0), software_trigger(0),
+          trigger_latency(0)
+    {}
+};
+
+/// Events of a module accumulated since they were last sent to the statistics (see report_events).
+/// The counts saturate. A single trigger latency is held: the next ones are only counted until
+/// it is sent.
+struct module_events_counts {
+    ap_uint<16> triggers;
+    ap_uint<16> decision_full_cycles;
+    ap_uint<16> notification_full_cycles;
+    ap_uint<16> configuration_updates;
+    ap_uint<16> software_triggers;
+    ap_uint<1> trigger_latency_valid;  /// trigger_latency is set, for the latency histogram
+    ap_uint<32> trigger_latency;       /// latency of a market data driven trigger
+    ap_uint<16> trigger_latencies_lost; /// market data driven trigger latencies not held
+
+    module_events_counts()
+        : triggers(0), decision_full_cycles(0), notification_full_cycles(0), configuration_updates(0),
+          software_triggers(0), trigger_latency_valid(0), trigger_latency(0), trigger_latencies_lost(0)
+    {}
+};
+
+/// Request of the software to send the trigger latency histogram of a module, forwarded by the
+/// configuration to the statistics
+struct latency_histogram_request {
+    ap_uint<8> module; /// statistics module
+    ap_uint<1> reset;  /// reset the histogram once read
+};
+
+/// Request of the software to send the counters at once, forwarded by the configuration to the
+/// statistics
+typedef ap_uint<1> statistics_request;
+
+/// Adds an event to a saturating count
+inline void
+count_event(ap_uint<16> & count, bool event)
+{
+    #pragma HLS INLINE
+    if (event && count != ap_uint<16>(-1))
+        ++count;
+}
+
+/// Adds the events of the cycle to the events not sent yet, 'pending', a state of the module,
+/// and sends them if any. The write never blocks the module: when the events FIFO is full,
+/// they are kept and sent with the next ones, so that the statistics never miss an event.
+inline void
+report_events(hls::stream<module_events_counts> & events_out, module_events_counts & pending,
+              module_events const& events)
+{
+    #pragma HLS INLINE
+    count_event(pending.triggers, events.trigger);
+    count_event(pending.decision_full_cycles, events.decision_full);
+    count_event(pending.notification_full_cycles, events.notification_full);
+    count_event(pending.configuration_updates, events.configuration_update);
+    count_event(pending.software_triggers, events.software_trigger);
+    if (events.trigger && ! events.software_trigger) {
+        count_event(pending.trigger_latencies_lost, pending.trigger_latency_valid);
+        if (! pending.trigger_latency_valid) {
+            pending.trigger_latency_valid = 1;
+            pending.trigger_latency = events.trigger_latency;
+        }
+    }
+
+    bool const any = pending.triggers != 0 || pending.decision_full_cycles != 0 || pending.notification_full_cycles != 0
+                     || pending.configuration_updates != 0 || pending.software_triggers != 0
+                     || pending.trigger_latencies_lost != 0;
+    if (any && events_out.write_nb(pending))
+        pending = module_events_counts();
+}
+
+}
+}
+}
@@ -0,0 +1,79 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "../include/enyx/hfp/hfp.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/// Notification already converted to DMA words, as sent by the notifications producers.
+/// The last word of the notification has its 'last' flag set.
+struct notification_payload {
+    typedef enyx::hfp::dma_user_channel_data_out word_type;
+    static std::size_t const max_word_count = 3;
+    word_type words[max_word_count];
+    ap_uint<2> word_count; /// words used, set from the producer notification_word_count
+};
+
+/// Count of notifications dropped by a producer, reported to the notifications monitor
+typedef ap_uint<16> notification_drop;
+
+/// Request of a notifications status, sent by the software (see Notifications::p_monitor_notifications)
+typedef ap_uint<1> notifications_status_request;
+
+/// Writes a notification without ever stalling the producer, as the trigger path shall not
+/// wait for the DMA egress: a notification which finds its FIFO full is dropped, and counted
+/// in 'drops', the producer count of the drops not reported yet (see report_notification_drops).
+inline void
+write_notification(hls::stream<notification_payload> & notification_out,
+                   notification_drop & drops,
+                   notification_payload const& notification)
+{
+    #pragma HLS INLINE
+    if (! notification_out.write_nb(notification) && drops != notification_drop(-1))
+        ++drops; // saturates, until the monitor gets it
+}
+
+/// Reports the drops counted by write_notification() to the notifications monitor (see
+/// Notifications::p_monitor_notifications) when its FIFO has room, without stalling the producer
+/// either: the count is kept, and grows, until then. Called by the producers on every cycle.
+inline void
+report_notification_drops(hls::stream<notification_drop> & drop_out, notification_drop & drops)
+{
+    #pragma HLS INLINE
+    if (drops != 0 && drop_out.write_nb(drops))
+        drops = 0;
+}
+
+/// Converts a notification to DMA words, with the Producer notification_to_word()
+template<typename Producer, typename Notification>
+notification_payload
+pack_notification(Notification const& notification)
+{
+    #pragma HLS INLINE
+    notification_payload ret;
+    for (int i = 0; i != Producer::notification_word_count; ++i)
+        ret.words[i] = Producer::notification_to_word(notification, i + 1);
+    ret.word_count = Producer::notification_word_count;
+    return ret;
+}
+
+}
+}
+}
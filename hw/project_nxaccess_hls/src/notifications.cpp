@@ -19,7 +19,11 @@
 #include <ap_fixed.h>
 #include <hls_stream.h>
 #include <cassert>
+#include <iostream>
 
+#include "../include/enyx/hls/aggregator.hpp"
+#include "../include/enyx/hls/clock.hpp"
+#include "../include/enyx/hls/serializer.hpp"
 #include "../include/enyx/md/hw/nxbus.hpp"
 
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
@@ -31,12 +35,6 @@
 #include "../include/enyx/hfp/hfp.hpp"
 #include "notifications.hpp"
 
-/// dependency upon all producing modules. See comments below for this design choice (low latency driven)
-#include "configuration.hpp"
-#include "tick2cancel.hpp"
-#include "tick2trade.hpp"
-#include "tcp_consumer.hpp"
-
 
 namespace nxmd = enyx::md::hw;
 namespace nxoe  = enyx::oe::hwstrat;
@@ -45,178 +43,154 @@ namespace enyx {
 namespace oe {
 namespace nxaccess_hw_algo {
 
-/// Converts specific module data buses to DMA "raw 128b data bus".
-/// A better design would be to be agnostic and only consider 128bits "data" buses as inputs of this process.
-/// However, it means that each module has to handle the FSM that converts data to a 128 bits data bus. Also,
-/// this adds latency into the core components.
-/// We can consider this not clean from a design & maintenance point of view ; right. Another approach might
-/// be to use variadic templates providing writers functions so that this code could be generic. Its complexity
-/// would not serve anymore the documentation purpose.
-void Notifications::p_broadcast_notifications(
-    hls::stream<user_dma_tick2cancel_notification> &tick2cancel_in,
-    hls::stream<user_dma_tick2trade_notification> &tick2trade_in,
-    hls::stream<user_dma_update_instrument_configuration_ack> &config_acks_in,
-    hls::stream<user_dma_tcp_consumer_notification> &tcp_consumer_in,
+struct notifications_to_dma {};
+struct notifications_aggregation {};
+typedef enyx::hls_tools::serializer<notifications_to_dma, notification_bus_count, notification_payload> notifications_serializer_type;
 
+/// Serialized notifications aggregation in DMA packets of up to PacketMaxWordCount words
+template<std::size_t PacketMaxWordCount>
+struct notifications_packets
+{
+    static void
+    p_run(hls::stream<notification_payload> (&notifications_in)[notification_bus_count],
+          hls::stream<enyx::hfp::dma_user_channel_data_out> & conf_out)
+    {
+        #pragma HLS INLINE
+        static hls::stream<enyx::hfp::dma_user_channel_data_out> serialized_notifications;
+        #pragma HLS STREAM variable=serialized_notifications depth=1
+
+        notifications_serializer_type::p_serialize(notifications_in, serialized_notifications);
+
+        typedef enyx::hls_tools::aggregator<notifications_aggregation,
+                                            enyx::hfp::dma_user_channel_data_out,
+                                            PacketMaxWordCount,
+                                            notification_payload::max_word_count,
+                                            notification_packet_timeout> notifications_aggregator_type;
+        notifications_aggregator_type::p_aggregate(serialized_notifications, conf_out);
+    }
+};
+
+/// No aggregation: a DMA packet per notification
+template<>
+struct notifications_packets<0>
+{
+    static void
+    p_run(hls::stream<notification_payload> (&notifications_in)[notification_bus_count],
+          hls::stream<enyx::hfp::dma_user_channel_data_out> & conf_out)
+    {
+        #pragma HLS INLINE
+        notifications_serializer_type::p_serialize(notifications_in, conf_out);
+    }
+};
+
+/// Serializes the notifications into the DMA "raw 128b data bus", in round robin between the
+/// strategies, the configuration and the TCP consumer so that none of them starves.
+/// All the producers send their notifications already converted to DMA words (see
+/// pack_notification()), so that this process does not depend on the strategies list nor on
+/// the notifications formats.
+/// The notifications are optionally aggregated in bigger DMA packets (see
+/// notification_packet_max_word_count), the software iterating over the messages of a packet.
+void Notifications::p_broadcast_notifications(
+    hls::stream<notification_payload> (&notifications_in)[notification_bus_count],
     hls::stream<enyx::hfp::dma_user_channel_data_out> & conf_out)
 {
 #pragma HLS INLINE recursive
-#pragma HLS PIPELINE enable_flush
 
-    static enum  { IDLE,  /// doing nothing, waiting for input
-                   WORD1, /// will write word 1 of notification
-                   WORD2, /// will write word 2 of notification
-                   WORD3, /// will write word 3 of notification
-                //    WORD4 /// will write word 4 of notification
-                 } current_state; /// current state of FSM
-    #pragma HLS RESET variable=current_state
-
-
-    static enum { Input_Tick2trade = 1,
-                 Input_Tick2cancel = 2,
-                 Input_Configuration = 3,
-                 Input_TcpConsumer = 4, }
-                 input_type;  // input type being processed
-    #pragma HLS RESET variable=input_type
-
-    static user_dma_tick2trade_notification             notif_t2trade;
-    static user_dma_update_instrument_configuration_ack notif_config;
-    static user_dma_tick2cancel_notification            notif_t2cancel;
-    static user_dma_tcp_consumer_notification           notif_tcp;
-
-// note on this FSM : we could remove one state and spare 1 clk cycle;
-// we choose to separate the IDLE state from WORD1 for clarity.
-switch(current_state) {
-    // doing nothing, waiting for input
-    case IDLE  : {
-            // got an input from configuration core
-            if(!config_acks_in.empty()) {
-                input_type = Input_Configuration;
-                notif_config = config_acks_in.read();
-                current_state = WORD1;
-            }  else if (!tick2trade_in.empty()) {
-                input_type = Input_Tick2trade;
-                notif_t2trade = tick2trade_in.read();
-                current_state = WORD1;
-            } else if (!tick2cancel_in.empty()) {
-                input_type = Input_Tick2cancel;
-                notif_t2cancel = tick2cancel_in.read();
-                notif_t2cancel.header.timestamp = 0x0;
-                current_state = WORD1;
-            } else if (!tcp_consumer_in.empty()) {
-                input_type = Input_TcpConsumer;
-                notif_tcp = tcp_consumer_in.read();
-                current_state = WORD1;
-            }
-            // else { // no status change, nothing read ! }
-        break;
-    } // case idle
-
-    // will write word1
-    case WORD1 : {
-        switch(input_type) {
-
-        case Input_Configuration: {
-            enyx::hfp::dma_user_channel_data_out out;
-            enyx::oe::nxaccess_hw_algo::InstrumentConfiguration::write_word(notif_config, out, 1);
-            conf_out.write(out);
-            break;
-        }
-        case Input_Tick2cancel: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = Tick2cancel::notification_to_word(notif_t2cancel, 1);
-            conf_out.write(out);
-            break;
-        }
-        case Input_Tick2trade: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = Tick2trade::notification_to_word(notif_t2trade, 1);
-            conf_out.write(out);
-            break;
-        }
-        case Input_TcpConsumer: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = TcpConsumer::notification_to_word(notif_tcp, 1);
-            conf_out.write(out);
-            break;
-        }
-        default:
-            assert(false && "bad input types in WORD1 state ");
-
-        } // switch input_type
-        current_state = WORD2;
-        break;
-    } // case word1
-    // will output second word
-    case WORD2: {
-        switch(input_type) {
-
-        case Input_Configuration: {
-            enyx::hfp::dma_user_channel_data_out out;
-            InstrumentConfiguration::write_word(notif_config, out, 2);
-            conf_out.write(out);
-            current_state = WORD3;
-            break;
-        }
-        case Input_Tick2cancel: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = Tick2cancel::notification_to_word(notif_t2cancel, 2);
-            conf_out.write(out);
-            current_state = WORD3;
-            break;
-        }
-        case Input_Tick2trade: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = Tick2trade::notification_to_word(notif_t2trade, 2);
-            conf_out.write(out);
-            current_state = IDLE; // we have finished for this notification type
-            break;
-        }
-        case Input_TcpConsumer: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = TcpConsumer::notification_to_word(notif_tcp, 2);
-            conf_out.write(out);
-            current_state = IDLE; // we have finished for this notification type
-            break;
-        }
-        default:
-            assert(false && "bad input types in WORD2 state ");
+    notifications_packets<notification_packet_max_word_count>::p_run(notifications_in, conf_out);
+
+} // process
 
-        } // switch input_type
-        break;
-    }// case word2
+/// The status message is written without blocking either: when its FIFO is full, it is
+/// counted as dropped on notification_bus_status, and the next period reports the counters.
+/// A status requested by the software doesn't move the periodic ones.
+void Notifications::p_monitor_notifications(
+    hls::stream<notification_drop> (&drops_in)[notification_producer_count],
+    hls::stream<notifications_status_request> & status_requests_in,
+    hls::stream<notification_payload> & status_out,
+    enyx::hls_tools::cycle_count now)
+{
+#pragma HLS INLINE recursive
+#pragma HLS PIPELINE enable_flush
 
-     // will output second word
-    case WORD3: {
-        switch(input_type) {
+    static ap_uint<32> dropped[notification_bus_count]; /// notifications dropped per bus
+    #pragma HLS ARRAY_PARTITION variable=dropped complete dim=1
+    #pragma HLS RESET variable=dropped
+    static ap_uint<32> sequence_number = 0;
+    #pragma HLS RESET variable=sequence_number
+    static ap_uint<32> cycles_left = notification_status_period - 1; /// cycles before the next status
+    #pragma HLS RESET variable=cycles_left
+
+    for (std::size_t i = 0; i != notification_producer_count; ++i)
+        if (! drops_in[i].empty())
+            dropped[notification_producer_bus(i)] += drops_in[i].read();
+
+    bool const requested = ! status_requests_in.empty();
+    if (requested)
+        status_requests_in.read();
+
+    if (cycles_left == 0 || requested) {
+        assert(notification_bus_count <= 8 && "user_dma_notifications_status reports up to 8 buses");
+        user_dma_notifications_status status;
+        status.header.reserved = 0;
+        status.header.error = 0;
+        status.header.timestamp = now;
+        status.header.version = 1;
+        status.header.source = NotificationsStatus;
+        status.header.msg_type = 1;
+        status.header.length = 16 * 3;
+        status.sequence_number = sequence_number;
+        status.bus_count = notification_bus_count;
+        for (std::size_t i = 0; i != 8; ++i)
+            status.dropped[i] = i < notification_bus_count ? uint32_t(dropped[i]) : 0;
+
+        std::cout << "[NOTIFICATIONS] status #" << std::dec << sequence_number << "\n";
+        if (! status_out.write_nb(pack_notification<Notifications>(status)))
+            ++dropped[notification_bus_status];
+
+        ++sequence_number;
+    }
+
+    if (cycles_left == 0)
+        cycles_left = notification_status_period - 1;
+    else
+        --cycles_left;
+}
 
-        case Input_Configuration: {
-            enyx::hfp::dma_user_channel_data_out out;
-            InstrumentConfiguration::write_word(notif_config, out, 3);
-            conf_out.write(out);
-            current_state = IDLE; // we have finished
+enyx::hfp::dma_user_channel_data_out
+Notifications::notification_to_word(const user_dma_notifications_status& status_in, int word_index)
+{
+    enyx::hfp::dma_user_channel_data_out out_word;
+
+    switch(word_index) {
+        case 1: {
+            out_word.data(127, 64) = enyx::oe::hwstrat::get_word(status_in.header); //64
+            out_word.data(63, 32) = status_in.sequence_number; //32
+            out_word.data(31, 24) = status_in.bus_count; //8
+            out_word.data(23, 0) = 0;
+            out_word.last = 0;
+            break;
+        }
+        case 2: {
+            out_word.data(127, 96) = status_in.dropped[0];
+            out_word.data(95, 64) = status_in.dropped[1];
+            out_word.data(63, 32) = status_in.dropped[2];
+            out_word.data(31, 0) = status_in.dropped[3];
+            out_word.last = 0;
             break;
         }
-        case Input_Tick2cancel: {
-            enyx::hfp::dma_user_channel_data_out out;
-            out = Tick2cancel::notification_to_word(notif_t2cancel, 3);
-            conf_out.write(out);
-            current_state = IDLE;
+        case 3: {
+            out_word.data(127, 96) = status_in.dropped[4];
+            out_word.data(95, 64) = status_in.dropped[5];
+            out_word.data(63, 32) = status_in.dropped[6];
+            out_word.data(31, 0) = status_in.dropped[7];
+            out_word.last = 1;
             break;
         }
         default:
-            assert(false && "Only handling 2 input types in WORD3 state ");
-
-        } // switch input_type
-        break;
-    }// case word3
-    default:
-        assert(false && "invalid state in FSM ");
-
-    } // switch current state
-
-} // process
-
+            assert(false && "Handling only 3 words for user_dma_notifications_status encoding");
+    }
+    return out_word;
+}
 
 }
 }
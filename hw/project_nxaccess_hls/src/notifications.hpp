@@ -18,6 +18,7 @@
 #include <hls_stream.h>
 
 #include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/hls/clock.hpp"
 
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
 #include "../include/enyx/oe/hwstrat/msg_headers.hpp"
@@ -26,6 +27,7 @@
 
 #include "messages.hpp"
 #include "../include/enyx/hfp/hfp.hpp"
+#include "notification_payload.hpp"
 #include "configuration.hpp" // for enyx::hfp::hls, FIXME.
 
 namespace nxmd = enyx::md::hw;
@@ -38,6 +40,29 @@ namespace nxaccess_hw_algo {
 // using namespace enyx::hfp::hls;
 // void write_word(user_dma_update_instrument_configuration& in, ap_uint<128>& out_word, int word_index);
 
+/// notifications serializer inputs: one per strategy, then the configuration acks, the TCP consumer,
+/// the statistics and the notifications status.
+static const std::size_t notification_bus_count = strategy_count + 4;
+static const std::size_t notification_bus_configuration = strategy_count;
+static const std::size_t notification_bus_tcp_consumer = strategy_count + 1;
+static const std::size_t notification_bus_statistics = strategy_count + 2;
+static const std::size_t notification_bus_status = strategy_count + 3;
+
+/// producers which drop the notifications finding their FIFO full, and report the count of their
+/// drops to the monitor: one per strategy, then the TCP consumer and the statistics. The configuration acks
+/// are never dropped, the software waits for them.
+static const std::size_t notification_producer_count = strategy_count + 2;
+static const std::size_t notification_producer_tcp_consumer = strategy_count;
+static const std::size_t notification_producer_statistics = strategy_count + 1;
+
+/// Notification bus of a producer reporting its drops
+inline std::size_t
+notification_producer_bus(std::size_t producer)
+{
+    #pragma HLS INLINE
+    return producer < notification_bus_configuration ? producer : producer + 1;
+}
+
 
 /// Handles notifications from modules, and broadcast them into the DMA 
 /// This process allows some simplification in other modules
@@ -46,13 +71,20 @@ class Notifications
   public:
 
     static void
-    p_broadcast_notifications(hls::stream<user_dma_tick2cancel_notification> &tick2cancel_in, 
-                              hls::stream<user_dma_tick2trade_notification> &tick2trade_in,
-                              hls::stream<user_dma_update_instrument_configuration_ack> &config_acks_in,
-                              hls::stream<user_dma_tcp_consumer_notification> &tcp_consumer_in,
+    p_broadcast_notifications(hls::stream<notification_payload> (&notifications_in)[notification_bus_count],
                               hls::stream<enyx::hfp::dma_user_channel_data_out> & conf_out);
 
-  
+    /// Counts the notifications dropped per bus, and reports them every notification_status_period
+    /// cycles in a user_dma_notifications_status, or when the software requests it.
+    static void
+    p_monitor_notifications(hls::stream<notification_drop> (&drops_in)[notification_producer_count],
+                            hls::stream<notifications_status_request> & status_requests_in,
+                            hls::stream<notification_payload> & status_out,
+                            enyx::hls_tools::cycle_count now);
+
+    static enyx::hfp::dma_user_channel_data_out
+    notification_to_word(const user_dma_notifications_status& status_in, int word_index);
+    static const int notification_word_count = 3; /// words written by notification_to_word()
 };
 
 }
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets, 
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+
+#include "../include/enyx/md/hw/books.hpp"
+#include "../include/enyx/md/hw/instrument_map.hpp"
+#include "../include/enyx/md/hw/orders.hpp"
+#include "../include/enyx/hls/typelist.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/// Core wide parameters, shared by the top level and the strategies.
+/// Modification of these constants will change the whole core behavior.
+
+/// Trading strategies registry: the nxbus fan-out, the memories read ports, the trigger arbitration
+/// and the notifications inputs are generated from this list (see strategies.hpp).
+/// A strategy class provides p_run(), notification_to_word(), notification_word_count and
+/// decision_priority_class.
+class Tick2cancel;
+class Tick2trade;
+typedef enyx::hls_tools::typelist<class Tick2cancel,
+        enyx::hls_tools::typelist<class Tick2trade> > strategies;
+
+/// number of trading strategies
+static const std::size_t strategy_count = enyx::hls_tools::length<strategies>::value;
+
+/// priority classes of the trigger arbiter inputs, the first being served first, the inputs of a
+/// class in round robin: each strategy has its class, then come the software triggers & the TCP consumer
+enum decision_priority_classes {
+    CancelPriority = 0,
+    RiskPriority = 1,
+    TradePriority = 2,
+    SoftwareTriggerPriority = 3,
+    TcpConsumerPriority = 4,
+    decision_priority_class_count = 5
+};
+
+/// number of instruments slots handled by the core (up to 65536, nxbus user field width),
+/// slot 0 is reserved for the instruments which are not configured
+static const std::size_t instrument_count = 4096;
+
+/// number of ways of the instrument id to slot map
+static const std::size_t instrument_map_ways = 4;
+
+/// number of price levels stored per book side
+static const std::size_t book_depth = 5;
+
+/// number of price levels tracked per book side to apply the updates (>= book_depth): the levels
+/// deleted from the top are refilled from the book_tracked_depth - book_depth next ones
+static const std::size_t book_tracked_depth = 16;
+
+/// number of strategies reading the books memory
+static const std::size_t book_client_count = strategy_count;
+
+/// whether the strategies read the instrument configuration and the top of book from the
+/// unified instrument state memory (one request, one memory latency), or from the configuration
+/// and books memories (see InstrumentState)
+static const bool fused_instrument_state = true;
+
+/// whether the instrument state memory also stores the tick to cancel trigger levels, computed
+/// on configuration & top of book updates, so that the decision is a single compare
+/// (requires fused_instrument_state)
+static const bool precomputed_trigger_levels = true;
+
+/// notifications aggregation: several notifications are sent in a single DMA packet of up to
+/// notification_packet_max_word_count words (16B each), flushed when no notification came for
+/// notification_packet_timeout cycles. 0 disables the aggregation: a DMA packet per notification.
+static const std::size_t notification_packet_max_word_count = 0;
+static const std::size_t notification_packet_timeout = 64;
+
+/// cycles between two notifications status messages, reporting the notifications dropped
+/// because their FIFO was full (2^24 cycles: 67 ms at 250 MHz)
+static const std::size_t notification_status_period = 1 << 24;
+
+/// cycles between two statistics reports (250 000 000 cycles: 1 s at 250 MHz)
+static const std::size_t statistics_period = 250000000;
+
+/// trigger latency histograms of the statistics: bucket i counts the triggers issued i * width to
+/// (i + 1) * width - 1 cycles after the first nxbus word of their market data, the last bucket
+/// counting the longer ones
+static const std::size_t latency_histogram_bucket_count = 16;
+static const std::size_t latency_histogram_bucket_width = 4;
+
+/// Books memory used by the strategies, indexed by instrument slot. With fused_instrument_state,
+/// the strategies read the top of book from the instrument state memory instead.
+typedef enyx::md::hw::BooksData<book_client_count, instrument_count, book_depth, book_tracked_depth,
+                                ! fused_instrument_state> Books;
+
+/// number of live orders tracked to build the books from the order level commands
+static const std::size_t order_capacity = 65536;
+
+/// number of ways of the orders table
+static const std::size_t order_ways = 4;
+
+/// number of orders stored aside when their orders table set is full
+static const std::size_t order_victim_count = 16;
+
+/// Order level book builder, feeding the books memory
+typedef enyx::md::hw::OrderBook<Books, order_capacity, order_ways, order_victim_count> OrderBook;
+
+/// Map from nxbus instrument ids to instrument slots
+struct instrument_map_id {};
+typedef enyx::md::hw::InstrumentMap<instrument_map_id, instrument_count, instrument_map_ways> InstrumentMap;
+
+}}} // Namespaces
@@ -0,0 +1,277 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+
+#include <cassert>
+#include <iostream>
+
+#include "../include/enyx/hls/clock.hpp"
+#include "../include/enyx/oe/hwstrat/helpers.hpp"
+
+#include "statistics.hpp"
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/// Latency histogram bucket of a trigger latency, the last bucket holding the longer latencies
+static ap_uint<8>
+latency_bucket(ap_uint<32> latency)
+{
+    #pragma HLS INLINE
+    if (latency >= latency_histogram_bucket_count * latency_histogram_bucket_width)
+        return latency_histogram_bucket_count - 1;
+    return latency / latency_histogram_bucket_width;
+}
+
+/// The counters keep counting while the pages of a report are sent, a page per cycle.
+/// A histogram page is read, and reset when requested, before the latencies of the cycle are
+/// added: a reset never loses a trigger. A histogram page is only reset once written, a page
+/// finding its FIFO full is sent again on the next cycle rather than dropped.
+void
+Statistics::p_collect(hls::stream<nxmd::nxbus_axi> & nxbus_in,
+                      hls::stream<ap_uint<nxbus_bus_count> > & nxbus_full_in,
+                      hls::stream<module_events_counts> (& events_in)[statistics_module_count],
+                      hls::stream<latency_histogram_request> & histogram_requests_in,
+                      hls::stream<statistics_request> & statistics_requests_in,
+                      hls::stream<notification_payload> & statistics_out,
+                      hls::stream<notification_drop> & statistics_drop_out,
+                      enyx::hls_tools::cycle_count now)
+{
+    #pragma HLS INLINE recursive
+    #pragma HLS PIPELINE enable_flush
+
+    static ap_uint<32> counters[counter_count];
+    #pragma HLS ARRAY_PARTITION variable=counters complete dim=1
+    #pragma HLS RESET variable=counters
+
+    static bool start_of_nxbus_command = true;
+    #pragma HLS RESET variable=start_of_nxbus_command
+
+    static ap_uint<32> cycles_left = statistics_period - 1; /// cycles before the next report
+    #pragma HLS RESET variable=cycles_left
+    static bool reporting = false; /// pages of a report being sent
+    #pragma HLS RESET variable=reporting
+    static ap_uint<8> page = 0; /// next page to send
+    #pragma HLS RESET variable=page
+    static ap_uint<32> sequence_number = 0;
+    #pragma HLS RESET variable=sequence_number
+
+    static ap_uint<32> histograms[statistics_module_count][latency_histogram_bucket_count];
+    #pragma HLS ARRAY_PARTITION variable=histograms complete dim=0
+    #pragma HLS RESET variable=histograms
+    static latency_histogram_request histogram_request; /// request being answered
+    static bool histogram_pending = false; /// pages of histogram_request being sent
+    #pragma HLS RESET variable=histogram_pending
+    static ap_uint<8> histogram_page = 0; /// next histogram page to send
+    #pragma HLS RESET variable=histogram_page
+    static notification_drop notification_drops = 0; /// counters pages dropped, not reported yet
+    #pragma HLS RESET variable=notification_drops
+
+    // nxbus activity
+    if (! nxbus_in.empty()) {
+        nxmd::nxbus const nxbus_word_in = static_cast<nxmd::nxbus>(nxbus_in.read());
+        ++counters[NxbusPage * counters_per_page + NxbusWords];
+        if (start_of_nxbus_command) {
+            ++counters[NxbusPage * counters_per_page + NxbusCommands];
+            ++counters[NxbusOpcodeClassPage * counters_per_page + (nxbus_word_in.opcode >> 4)];
+            if (nxbus_word_in.opcode == nxmd::NXBUS_OPCODE_TRADE_SUMMARY)
+                ++counters[NxbusPage * counters_per_page + NxbusTradeSummaries];
+        }
+        start_of_nxbus_command = nxbus_word_in.end_of_extra; // end_of_extra is set on the last word of a given command
+    }
+
+    // nxbus fan-out backpressure
+    if (! nxbus_full_in.empty()) {
+        ap_uint<nxbus_bus_count> const full = nxbus_full_in.read();
+        for (std::size_t i = 0; i != nxbus_bus_count; ++i)
+            if (full[i])
+                ++counters[NxbusFullPage * counters_per_page + i];
+    }
+
+    // histogram page, written when no counters page is, then reset if requested
+    bool const histogram_known_module = histogram_request.module < statistics_module_count;
+    bool const histogram_sending = histogram_pending && ! reporting;
+    user_dma_latency_histogram histogram;
+    histogram.header.reserved = 0;
+    histogram.header.error = ! histogram_known_module;
+    histogram.header.timestamp = now;
+    histogram.header.version = 1;
+    histogram.header.source = StatisticsCounters;
+    histogram.header.msg_type = LatencyHistogramMessage;
+    histogram.header.length = 16 * 3;
+    histogram.module = histogram_request.module;
+    histogram.reset = histogram_request.reset;
+    histogram.bucket_width = latency_histogram_bucket_width;
+    histogram.page = histogram_page;
+    histogram.page_count = histogram_known_module ? histogram_page_count : 1;
+    for (std::size_t i = 0; i != counters_per_page; ++i)
+        histogram.buckets[i] = 0;
+    for (std::size_t module = 0; module != statistics_module_count; ++module)
+        if (module == histogram_request.module)
+            for (std::size_t i = 0; i != counters_per_page; ++i)
+                histogram.buckets[i] = histograms[module][histogram_page * counters_per_page + i];
+    bool const histogram_written = histogram_sending
+                                   && statistics_out.write_nb(pack_notification<Statistics>(histogram));
+    for (std::size_t module = 0; module != statistics_module_count; ++module)
+        if (module == histogram_request.module && histogram_written && histogram_request.reset)
+            for (std::size_t i = 0; i != counters_per_page; ++i)
+                histograms[module][histogram_page * counters_per_page + i] = 0;
+
+    // modules events
+    for (std::size_t module = 0; module != statistics_module_count; ++module) {
+        if (! events_in[module].empty()) {
+            module_events_counts const events = events_in[module].read();
+            std::size_t const base = (ModulesPage + module) * counters_per_page;
+            counters[base + ModuleTriggers] += events.triggers;
+            if (events.trigger_latency_valid)
+                ++histograms[module][latency_bucket(events.trigger_latency)];
+            counters[base + ModuleDecisionFullCycles] += events.decision_full_cycles;
+            counters[base + ModuleNotificationFullCycles] += events.notification_full_cycles;
+            counters[base + ModuleConfigurationUpdates] += events.configuration_updates;
+            counters[base + ModuleSoftwareTriggers] += events.software_triggers;
+            counters[base + ModuleTriggerLatenciesLost] += events.trigger_latencies_lost;
+        }
+    }
+
+    // report
+    if (reporting) {
+        assert(nxbus_bus_count <= counters_per_page && "the nxbus fan-out outputs don't fit in a page");
+        user_dma_statistics statistics;
+        statistics.header.reserved = 0;
+        statistics.header.error = 0;
+        statistics.header.timestamp = now;
+        statistics.header.version = 1;
+        statistics.header.source = StatisticsCounters;
+        statistics.header.msg_type = CountersMessage;
+        statistics.header.length = 16 * 3;
+        statistics.sequence_number = sequence_number;
+        statistics.page = page;
+        statistics.page_count = page_count;
+        for (std::size_t i = 0; i != counters_per_page; ++i)
+            statistics.counters[i] = counters[page * counters_per_page + i];
+        write_notification(statistics_out, notification_drops, pack_notification<Statistics>(statistics));
+
+        if (page == page_count - 1) {
+            std::cout << "[STATISTICS] report #" << std::dec << sequence_number << " sent\n";
+            reporting = false;
+            ++sequence_number;
+        } else {
+            ++page;
+        }
+    } else if (histogram_sending) {
+        // written above, a page not written is sent again on the next cycle
+        if (histogram_written && histogram_page == histogram.page_count - 1) {
+            std::cout << "[STATISTICS] latency histogram of module " << std::dec << histogram_request.module << " sent\n";
+            histogram_pending = false;
+        } else if (histogram_written) {
+            ++histogram_page;
+        }
+    } else if (! histogram_pending && ! histogram_requests_in.empty()) {
+        histogram_request = histogram_requests_in.read();
+        histogram_pending = true;
+        histogram_page = 0;
+    }
+
+    // a requested report waits for the end of the one being sent
+    bool const requested = ! reporting && ! statistics_requests_in.empty();
+    if (requested)
+        statistics_requests_in.read();
+
+    if (cycles_left == 0 || requested) {
+        reporting = true;
+        page = 0;
+    }
+
+    if (cycles_left == 0)
+        cycles_left = statistics_period - 1;
+    else
+        --cycles_left;
+
+    report_notification_drops(statistics_drop_out, notification_drops);
+}
+
+enyx::hfp::dma_user_channel_data_out
+Statistics::notification_to_word(const user_dma_statistics& statistics_in, int word_index)
+{
+    enyx::hfp::dma_user_channel_data_out out_word;
+
+    switch(word_index) {
+        case 1: {
+            out_word.data(127, 64) = enyx::oe::hwstrat::get_word(statistics_in.header); //64
+            out_word.data(63, 32) = statistics_in.sequence_number; //32
+            out_word.data(31, 16) = statistics_in.page; //16
+            out_word.data(15, 0) = statistics_in.page_count; //16
+            out_word.last = 0;
+            break;
+        }
+        case 2: {
+            out_word.data(127, 96) = statistics_in.counters[0];
+            out_word.data(95, 64) = statistics_in.counters[1];
+            out_word.data(63, 32) = statistics_in.counters[2];
+            out_word.data(31, 0) = statistics_in.counters[3];
+            out_word.last = 0;
+            break;
+        }
+        case 3: {
+            out_word.data(127, 96) = statistics_in.counters[4];
+            out_word.data(95, 64) = statistics_in.counters[5];
+            out_word.data(63, 32) = statistics_in.counters[6];
+            out_word.data(31, 0) = statistics_in.counters[7];
+            out_word.last = 1;
+            break;
+        }
+        default:
+            assert(false && "Handling only 3 words for user_dma_statistics encoding");
+    }
+    return out_word;
+}
+
+enyx::hfp::dma_user_channel_data_out
+Statistics::notification_to_word(const user_dma_latency_histogram& histogram_in, int word_index)
+{
+    enyx::hfp::dma_user_channel_data_out out_word;
+
+    switch(word_index) {
+        case 1: {
+            out_word.data(127, 64) = enyx::oe::hwstrat::get_word(histogram_in.header); //64
+            out_word.data(63, 56) = histogram_in.module; //8
+            out_word.data(55, 48) = histogram_in.reset; //8
+            out_word.data(47, 32) = histogram_in.bucket_width; //16
+            out_word.data(31, 16) = histogram_in.page; //16
+            out_word.data(15, 0) = histogram_in.page_count; //16
+            out_word.last = 0;
+            break;
+        }
+        case 2: {
+            out_word.data(127, 96) = histogram_in.buckets[0];
+            out_word.data(95, 64) = histogram_in.buckets[1];
+            out_word.data(63, 32) = histogram_in.buckets[2];
+            out_word.data(31, 0) = histogram_in.buckets[3];
+            out_word.last = 0;
+            break;
+        }
+        case 3: {
+            out_word.data(127, 96) = histogram_in.buckets[4];
+            out_word.data(95, 64) = histogram_in.buckets[5];
+            out_word.data(63, 32) = histogram_in.buckets[6];
+            out_word.data(31, 0) = histogram_in.buckets[7];
+            out_word.last = 1;
+            break;
+        }
+        default:
+            assert(false && "Handling only 3 words for user_dma_latency_histogram encoding");
+    }
+    return out_word;
+}
+
+}}} // Namespaces
@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstddef>
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/hfp/hfp.hpp"
+#include "../include/enyx/hls/clock.hpp"
+#include "parameters.hpp"
+#include "strategies.hpp"
+#include "messages.hpp"
+#include "module_events.hpp"
+#include "notification_payload.hpp"
+
+namespace nxmd = enyx::md::hw;
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/**
+ * @brief Counts the core activity, and reports the counters every statistics_period cycles,
+ * in pages of 8 counters (see user_dma_statistics). The counters wrap, the software computes
+ * the activity of a period from two reports.
+ * Also builds a trigger latency histogram per module, sent on software request
+ * (see user_dma_latency_histogram).
+ */
+class Statistics
+{
+public:
+    static const std::size_t counters_per_page = 8;
+
+    /// Pages of the counters
+    enum pages {
+        NxbusPage = 0,            /// nxbus activity, see nxbus_counters
+        NxbusOpcodeClassPage = 1, /// 2 pages: nxbus commands per opcode class (opcode high nibble)
+        NxbusFullPage = 3,        /// cycles each nxbus fan-out output was full
+        ModulesPage = 4           /// a page per module (see statistics_module_count), see module_counters
+    };
+    static const std::size_t page_count = ModulesPage + statistics_module_count;
+    static const std::size_t counter_count = page_count * counters_per_page;
+    static const std::size_t histogram_page_count = latency_histogram_bucket_count / counters_per_page;
+
+    /// Message types of the statistics
+    enum messages_types {
+        CountersMessage = 1,        /// user_dma_statistics
+        LatencyHistogramMessage = 2 /// user_dma_latency_histogram
+    };
+
+    /// Counters of the NxbusPage
+    enum nxbus_counters {
+        NxbusWords = 0,         /// words received
+        NxbusCommands = 1,      /// commands received
+        NxbusTradeSummaries = 2 /// trade summaries received, processed by the strategies
+    };
+
+    /// Counters of a module page
+    enum module_counters {
+        ModuleTriggers = 0,               /// trigger commands written
+        ModuleDecisionFullCycles = 1,     /// cycles the trigger commands FIFO was full
+        ModuleNotificationFullCycles = 2, /// cycles the notifications FIFO was full
+        ModuleConfigurationUpdates = 3,   /// instrument configurations applied
+        ModuleSoftwareTriggers = 4,       /// software triggers issued
+        ModuleTriggerLatenciesLost = 5    /// trigger latencies missing from the histogram, under backpressure
+    };
+
+    /**
+     * @brief Statistics::p_collect Counts the nxbus commands read from its nxbus fan-out output, the
+     * nxbus fan-out outputs full cycles and the modules events, and sends the counters pages.
+     * The counters pages are sent periodically, or when the software requests them.
+     * The trigger latencies reported by the modules are added to their histogram, whose pages are
+     * sent on request, in the cycles no counters page is sent.
+     */
+    static void
+    p_collect(hls::stream<nxmd::nxbus_axi> & nxbus_in,
+              hls::stream<ap_uint<nxbus_bus_count> > & nxbus_full_in,
+              hls::stream<module_events_counts> (& events_in)[statistics_module_count],
+              hls::stream<latency_histogram_request> & histogram_requests_in,
+              hls::stream<statistics_request> & statistics_requests_in,
+              hls::stream<notification_payload> & statistics_out,
+              hls::stream<notification_drop> & statistics_drop_out,
+              enyx::hls_tools::cycle_count now);
+
+    static enyx::hfp::dma_user_channel_data_out
+    notification_to_word(const user_dma_statistics& statistics_in, int word_index);
+    static enyx::hfp::dma_user_channel_data_out
+    notification_to_word(const user_dma_latency_histogram& histogram_in, int word_index);
+    static const int notification_word_count = 3; /// words written by notification_to_word()
+};
+
+}}} // Namespaces
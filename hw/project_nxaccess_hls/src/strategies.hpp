@@ -0,0 +1,189 @@
+//--------------------------------------------------------------------------------
+//--! Enyx Confidential
+//--!
+//--! Organization:          Enyx
+//--! Project Identifier:    010 - Enyx nxAccess HLS Framework
+//--! Author:                Raphael Charolois (raphael.charolois@enyx.com)
+//--!
+//--! © Copyright            Enyx 2019
+//--! © Copyright Notice:    The source code for this program is not published or otherwise divested of its trade secrets,
+//--!                        irrespective of what has been deposited with the U.S. Copyright Office.
+//--------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <hls_stream.h>
+
+#include "../include/enyx/hls/typelist.hpp"
+#include "../include/enyx/hls/clock.hpp"
+#include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/oe/hwstrat/nxoe.hpp"
+#include "parameters.hpp"
+#include "configuration.hpp"
+#include "instrument_state.hpp"
+#include "notifications.hpp"
+#include "module_events.hpp"
+
+// strategies of the registry (see parameters.hpp)
+#include "tick2cancel.hpp"
+#include "tick2trade.hpp"
+
+namespace nxmd = enyx::md::hw;
+namespace nxoe  = enyx::oe::hwstrat;
+
+namespace enyx {
+namespace oe {
+namespace nxaccess_hw_algo {
+
+/// nxbus fan-out outputs: one per strategy, then the price level and the order level books updaters,
+/// and the statistics
+static const std::size_t nxbus_bus_count = strategy_count + 3;
+static const std::size_t nxbus_bus_book_updates = strategy_count;
+static const std::size_t nxbus_bus_order_updates = strategy_count + 1;
+static const std::size_t nxbus_bus_statistics = strategy_count + 2;
+
+/// trigger arbiter inputs: one per strategy, then the TCP consumer and the software triggers
+static const std::size_t decision_bus_count = strategy_count + 2;
+static const std::size_t decision_bus_tcp_consumer = strategy_count;
+static const std::size_t decision_bus_software_trigger = strategy_count + 1;
+
+/// Commands forwarded to each nxbus fan-out output (see enyx::hls_tools::command_demuxer): the ones
+/// its consumer processes, every command for the statistics
+template<typename List = strategies, std::size_t Index = 0>
+struct nxbus_filters
+{
+    static bool
+    accepts(std::size_t bus_id, ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        return bus_id == Index ? List::head::accepts_nxbus_opcode(opcode)
+                               : nxbus_filters<typename List::tail, Index + 1>::accepts(bus_id, opcode);
+    }
+};
+
+template<std::size_t Index>
+struct nxbus_filters<enyx::hls_tools::null_type, Index>
+{
+    static bool
+    accepts(std::size_t bus_id, ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        if (bus_id == nxbus_bus_book_updates)
+            return Books::accepts_nxbus_opcode(opcode);
+        if (bus_id == nxbus_bus_order_updates)
+            return OrderBook::accepts_nxbus_opcode(opcode);
+        return true;
+    }
+};
+
+/// Priority class of each trigger arbiter input (see enyx::hls_tools::priority_arbiter)
+template<typename List = strategies, std::size_t Index = 0>
+struct decision_priorities
+{
+    static const std::size_t class_count = decision_priority_class_count;
+
+    static std::size_t
+    priority_class(std::size_t bus_id)
+    {
+        #pragma HLS INLINE
+        return bus_id == Index ? std::size_t(List::head::decision_priority_class)
+                               : decision_priorities<typename List::tail, Index + 1>::priority_class(bus_id);
+    }
+};
+
+template<std::size_t Index>
+struct decision_priorities<enyx::hls_tools::null_type, Index>
+{
+    static const std::size_t class_count = decision_priority_class_count;
+
+    static std::size_t
+    priority_class(std::size_t bus_id)
+    {
+        #pragma HLS INLINE
+        return bus_id == decision_bus_tcp_consumer ? std::size_t(TcpConsumerPriority)
+                                                   : std::size_t(SoftwareTriggerPriority);
+    }
+};
+
+/// Buses index of a strategy, i.e. its position in the registry
+template<typename Strategy>
+struct strategy_index
+{
+    static const std::size_t value = enyx::hls_tools::index_of<strategies, Strategy>::value;
+};
+
+/**
+ * @brief Instantiates the processes of each strategy of the list, connected to the buses at
+ * the strategy index: nxbus fan-out output, memories read ports, trigger arbiter input,
+ * notifications input, notification drops and statistics events report. All of them sample the
+ * same cycle count.
+ */
+template<typename List, std::size_t Index = 0>
+struct strategies_instantiator
+{
+    static void
+    p_run(hls::stream<nxmd::nxbus_axi> (& nxbus_in)[nxbus_bus_count],
+          hls::stream<InstrumentConfiguration::read_instrument_data_request> (& instrument_data_req)[strategy_count],
+          hls::stream<InstrumentConfiguration::instrument_configuration_response> (& instrument_data_in)[strategy_count],
+          hls::stream<Books::read_book_data_request> (& book_req_out)[strategy_count],
+          hls::stream<Books::book_entry> (& books_in)[strategy_count],
+          hls::stream<InstrumentState::read_instrument_state_request> (& state_req_out)[strategy_count],
+          hls::stream<InstrumentState::state_entry> (& state_in)[strategy_count],
+          hls::stream<nxoe::trigger_command_axi> (& trigger_axibus_out)[decision_bus_count],
+          hls::stream<notification_payload> (& notifications_out)[notification_bus_count],
+          hls::stream<notification_drop> (& notification_drops_out)[notification_producer_count],
+          hls::stream<module_events_counts> (& events_out)[statistics_module_count],
+          enyx::hls_tools::cycle_count now)
+    {
+        #pragma HLS INLINE
+        List::head::p_run(nxbus_in[Index],
+                          instrument_data_req[Index],
+                          instrument_data_in[Index],
+                          book_req_out[Index],
+                          books_in[Index],
+                          state_req_out[Index],
+                          state_in[Index],
+                          trigger_axibus_out[Index],
+                          notifications_out[Index],
+                          notification_drops_out[Index],
+                          events_out[Index],
+                          now);
+
+        strategies_instantiator<typename List::tail, Index + 1>::p_run(nxbus_in,
+                                                                       instrument_data_req,
+                                                                       instrument_data_in,
+                                                                       book_req_out,
+                                                                       books_in,
+                                                                       state_req_out,
+                                                                       state_in,
+                                                                       trigger_axibus_out,
+                                                                       notifications_out,
+                                                                       notification_drops_out,
+                                                                       events_out,
+                                                                       now);
+    }
+};
+
+template<std::size_t Index>
+struct strategies_instantiator<enyx::hls_tools::null_type, Index>
+{
+    static void
+    p_run(hls::stream<nxmd::nxbus_axi> (&)[nxbus_bus_count],
+          hls::stream<InstrumentConfiguration::read_instrument_data_request> (&)[strategy_count],
+          hls::stream<InstrumentConfiguration::instrument_configuration_response> (&)[strategy_count],
+          hls::stream<Books::read_book_data_request> (&)[strategy_count],
+          hls::stream<Books::book_entry> (&)[strategy_count],
+          hls::stream<InstrumentState::read_instrument_state_request> (&)[strategy_count],
+          hls::stream<InstrumentState::state_entry> (&)[strategy_count],
+          hls::stream<nxoe::trigger_command_axi> (&)[decision_bus_count],
+          hls::stream<notification_payload> (&)[notification_bus_count],
+          hls::stream<notification_drop> (&)[notification_producer_count],
+          hls::stream<module_events_counts> (&)[statistics_module_count],
+          enyx::hls_tools::cycle_count)
+    {
+        #pragma HLS INLINE
+    }
+};
+
+}}} // Namespaces
@@ -15,6 +15,7 @@
 #include <iostream>
 
 #include "../include/enyx/oe/hwstrat/helpers.hpp"
+#include "../include/enyx/hls/clock.hpp"
 
 #include "tcp_consumer.hpp"
 
@@ -27,13 +28,14 @@ namespace nxaccess_hw_algo {
  */
 
 static void
-fill_header(user_dma_tcp_consumer_notification& notification) {
+fill_header(user_dma_tcp_consumer_notification& notification, ap_uint<32> emission) {
     notification.header.reserved = 0;
     notification.header.error = 0;
+    notification.header.timestamp = emission; // cycle at which the packet end was read
     notification.header.version = 1;
     notification.header.source = enyx::oe::nxaccess_hw_algo::TcpConsumer;
     notification.header.msg_type = 0;
-    notification.header.length = 16 * 1;
+    notification.header.length = 16 * 2;
 }
 
 
@@ -77,20 +79,37 @@ bitCount (uint32_t value) {
 void
 TcpConsumer::p_consume_tcp(
     hls::stream<enyx::oe::hwstrat::tcp_reply_payload> &tcp_replies_in,
-    hls::stream<user_dma_tcp_consumer_notification> &tcp_consumer_notification_out,
-    hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output) {
+    hls::stream<notification_payload> &tcp_consumer_notification_out,
+    hls::stream<notification_drop> &tcp_consumer_notification_drop_out,
+    hls::stream<module_events_counts> &events_out,
+    hls::stream<enyx::oe::hwstrat::trigger_command_axi> &output,
+    enyx::hls_tools::cycle_count now) {
     static uint32_t bytes;
     static uint32_t words;
     static ap_uint<8> session;
+    static ap_uint<32> packet_arrival; /// cycle at which the first word of the packet was read
+    static notification_drop notification_drops = 0; /// notifications dropped, not reported yet
+    #pragma HLS RESET variable=notification_drops
+    static module_events_counts pending_events; /// events not sent to the statistics yet
+    #pragma HLS RESET variable=pending_events
+
+    module_events events;
+    events.decision_full = output.full();
+    events.notification_full = tcp_consumer_notification_out.full();
 
     bool tcp_reply_word_available;
 #ifndef __SYNTHESIS__
     std::cout << "tcp_replies_in.size() : " << tcp_replies_in.size() << '\n';
 #endif
-    tcp_reply_word_available = !tcp_replies_in.empty();
+    // the words wait for room in the trigger FIFO, so that the trigger of a packet end is written on
+    // the cycle the word is read, without blocking: the latency reported runs up to the trigger emission
+    tcp_reply_word_available = !tcp_replies_in.empty() && !output.full();
 
-    if (! tcp_reply_word_available)
+    if (! tcp_reply_word_available) {
+        report_notification_drops(tcp_consumer_notification_drop_out, notification_drops);
+        report_events(events_out, pending_events, events);
         return;
+    }
 
     enyx::oe::hwstrat::tcp_reply_payload tcp_reply_word;
     tcp_reply_word = tcp_replies_in.read();
@@ -99,6 +118,7 @@ TcpConsumer::p_consume_tcp(
     bool start_of_packet = (0 == words);
     if (start_of_packet) {
         session = tcp_reply_word.id;
+        packet_arrival = now;
     }
 
     bool end_of_packet = tcp_reply_word.last;
@@ -129,19 +149,22 @@ TcpConsumer::p_consume_tcp(
                 // as example, we trigger collection #1
 
                 enyx::oe::hwstrat::trigger_collection(output, 1024 + tcp_reply_word.user(7,0)+tcp_reply_word.data(7,0));
+                events.trigger = 1;
+                events.trigger_latency = now - packet_arrival;
             }
         }
 
         if (96 == session) {
 
             user_dma_tcp_consumer_notification notification;
-            fill_header(notification);
+            fill_header(notification, now);
             notification.words = words;
             notification.bytes = bytes;
             notification.keep = tcp_reply_word.keep;
             notification.user = tcp_reply_word.user;
             notification.session = session; 
-            tcp_consumer_notification_out.write(notification); // write to the internal notification data bus
+            write_notification(tcp_consumer_notification_out, notification_drops,
+                               pack_notification<TcpConsumer>(notification)); // write to the internal notification data bus
         }
         
         words = 0;
@@ -150,6 +173,9 @@ TcpConsumer::p_consume_tcp(
         words++;
         bytes += enyx::oe::hwstrat::tcp_reply_payload::data_width / 8;
     }
+
+    report_notification_drops(tcp_consumer_notification_drop_out, notification_drops);
+    report_events(events_out, pending_events, events);
 }
 
 enyx::hfp::dma_user_channel_data_out
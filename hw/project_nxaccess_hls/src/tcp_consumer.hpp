@@ -21,7 +21,10 @@
 #include "../include/enyx/md/hw/books.hpp"
 #include "../include/enyx/oe/hwstrat/tcp.hpp"
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
+#include "../include/enyx/hls/clock.hpp"
 #include "messages.hpp"
+#include "notification_payload.hpp"
+#include "module_events.hpp"
 
 namespace enyx {
 namespace oe {
@@ -37,11 +40,15 @@ public:
     static void
     p_consume_tcp(
         hls::stream<enyx::oe::hwstrat::tcp_reply_payload> & tcp_replies_in,
-        hls::stream<user_dma_tcp_consumer_notification> &tick2trade_notification_out,
-        hls::stream<enyx::oe::hwstrat::trigger_command_axi> & output);
+        hls::stream<notification_payload> &tcp_consumer_notification_out,
+        hls::stream<notification_drop> &tcp_consumer_notification_drop_out,
+        hls::stream<module_events_counts> &events_out,
+        hls::stream<enyx::oe::hwstrat::trigger_command_axi> & output,
+        enyx::hls_tools::cycle_count now);
 
     static enyx::hfp::dma_user_channel_data_out
     notification_to_word(const user_dma_tcp_consumer_notification& notif_in, int word_index);
+    static const int notification_word_count = 2; /// words written by notification_to_word()
 
 }; // class
 }}} // Namespaces
@@ -16,6 +16,7 @@
 #include <cassert>
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
 #include "../include/enyx/md/hw/nxbus.hpp"
+#include "../include/enyx/hls/clock.hpp"
 #include "tick2cancel.hpp"
 
 namespace enyx {
@@ -24,10 +25,11 @@ namespace nxaccess_hw_algo {
 
 using namespace enyx::oe::hwstrat;
 
-static void fill_header(user_dma_tick2cancel_notification& notification, Tick2cancel::notifications_messages_types message_type) {
+static void fill_header(user_dma_tick2cancel_notification& notification, Tick2cancel::notifications_messages_types message_type,
+                        ap_uint<32> emission) {
     notification.header.reserved = 0;
     notification.header.error = 0;
-    notification.header.timestamp = 0;
+    notification.header.timestamp = emission; // cycle at which the trigger is emitted
     notification.header.version = 1;
     notification.header.source = enyx::oe::nxaccess_hw_algo::Tick2cancel;
 
@@ -45,7 +47,10 @@ static void fill_header(user_dma_tick2cancel_notification& notification, Tick2ca
 
 void Tick2cancel::preprocess_nxbus(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
                                     hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
-                                    hls::stream<enyx::md::hw::BooksData<2,256>::read_book_data_request> & book_req_out, hls::stream<ContextData> & decision_data_out) {
+                                    hls::stream<Books::read_book_data_request> & book_req_out,
+                                    hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                                    hls::stream<ContextData> & decision_data_out,
+                                    enyx::hls_tools::cycle_count now) {
 #pragma HLS INLINE recursive
 #pragma HLS PIPELINE enable_flush
 
@@ -98,10 +103,16 @@ void Tick2cancel::preprocess_nxbus(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
                 // prepare & transfer decision data to trigger()
                 decision_data.price = nxbus_word_in.price;
                 decision_data.instr_id = nxbus_word_in.instr_id;
+                decision_data.arrival = now;
                 decision_data_out.write(decision_data);
 
-                instrument_data_req.write(nxbus_word_in.instr_id); // Request the instrument's configuration
-                book_req_out.write(nxbus_word_in.instr_id); // Request instrument's latest book to the book manager
+                // memories are indexed by the instrument slot, provided in the nxbus user field
+                if (fused_instrument_state) {
+                    state_req_out.write(nxbus_data_in.user); // Request the instrument's configuration & top of book
+                } else {
+                    instrument_data_req.write(nxbus_data_in.user); // Request the instrument's configuration
+                    book_req_out.write(nxbus_data_in.user); // Request instrument's latest book to the book manager
+                }
 
             } else {
                 // Here, we do nothing, as we don't know what to do
@@ -121,32 +132,68 @@ void Tick2cancel::preprocess_nxbus(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
 /**
  * @brief Tick2cancel::trigger Perform trigger action if algorithmic conditions are met.
  */
-void Tick2cancel::trigger(hls::stream<InstrumentConfiguration::instrument_configuration_data_item> & instrument_data_resp,
-                          hls::stream<enyx::md::hw::BooksData<2,256>::book_entry> & books_in,
+void Tick2cancel::trigger(hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_resp,
+                          hls::stream<Books::book_entry> & books_in,
+                          hls::stream<InstrumentState::state_entry> & state_in,
                           hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
-                          hls::stream<user_dma_tick2cancel_notification>& tick2cancel_notification_out,
-                          hls::stream<Tick2cancel::ContextData>& decision_data_in) {
+                          hls::stream<notification_payload> & tick2cancel_notification_out,
+                          hls::stream<notification_drop> & tick2cancel_notification_drop_out,
+                          hls::stream<module_events_counts> & events_out,
+                          hls::stream<Tick2cancel::ContextData>& decision_data_in,
+                          enyx::hls_tools::cycle_count now) {
 
 #pragma HLS INLINE recursive
 #pragma HLS PIPELINE enable_flush
 
+    static notification_drop notification_drops = 0; /// notifications dropped, not reported yet
+    #pragma HLS RESET variable=notification_drops
+    static module_events_counts pending_events; /// events not sent to the statistics yet
+    #pragma HLS RESET variable=pending_events
+
+    module_events events;
+    events.decision_full = trigger_axibus_out.full();
+    events.notification_full = tick2cancel_notification_out.full();
+
     // Waiting for the instrument's configuration & latest books data
-    if(!instrument_data_resp.empty() &&
-            !books_in.empty() &&
-            !decision_data_in.empty()) {
-        // Read conf data & books data
-        InstrumentConfiguration::instrument_configuration_data_item trigger_config = instrument_data_resp.read();
-        enyx::md::hw::BooksData<2,256>::book_entry book = books_in.read();
+    bool const precomputed_levels = fused_instrument_state && precomputed_trigger_levels;
+    bool const state_ready = fused_instrument_state ? !state_in.empty()
+                                                    : (!instrument_data_resp.empty() && !books_in.empty());
+    // The decision waits for room in the trigger FIFO, so that the trigger is written on the cycle
+    // it is taken, without blocking: the latency reported runs up to the trigger emission.
+    if(state_ready && !decision_data_in.empty() && !trigger_axibus_out.full()) {
+        // Read conf data & books top levels
+        InstrumentState::state_entry state;
+        if (fused_instrument_state) {
+            state = state_in.read();
+        } else {
+            InstrumentConfiguration::instrument_configuration_response const response = instrument_data_resp.read();
+            state.config = response.config;
+            state.epoch = response.epoch;
+            Books::book_entry const book = books_in.read();
+            state.bid = book.bid[0];
+            state.ask = book.ask[0];
+        }
+        InstrumentConfiguration::instrument_configuration_data_item const& trigger_config = state.config;
         Tick2cancel::ContextData decision_data = decision_data_in.read();
 
         // Algorithm : we test whether current trade summary price is out of a "threashold(ed)-scope", and
         // if so, trigger a collection for, presumability, cancelling some orders.
-        if ((book.bid_present) && trigger_config.enabled
-                && (decision_data.price <= book.bid_toplevel_price - trigger_config.tick_to_cancel_threshold)
-                && (trigger_config.tick_to_cancel_threshold != 0)) {
+        // with precomputed trigger levels, each side is a single compare
+        bool const bid_triggered = precomputed_levels
+            ? (state.tick_to_cancel_bid.armed && decision_data.price <= state.tick_to_cancel_bid.price)
+            : ((state.bid.present) && trigger_config.enabled
+                && (decision_data.price <= state.bid.price - trigger_config.tick_to_cancel_threshold)
+                && (trigger_config.tick_to_cancel_threshold != 0));
+        bool const ask_triggered = precomputed_levels
+            ? (state.tick_to_cancel_ask.armed && decision_data.price >= state.tick_to_cancel_ask.price)
+            : ((state.ask.present) && trigger_config.enabled
+                   && (decision_data.price >= state.ask.price + trigger_config.tick_to_cancel_threshold)
+                   && (trigger_config.tick_to_cancel_threshold != 0));
+
+        if (bid_triggered) {
 
             std::cout << "[TICK2CANCEL] trade summary below buy threshold ts=" << std::hex << decision_data.timestamp << " "
-                      << " price="  << decision_data.price << " <= threshold price=" << (book.bid_toplevel_price - trigger_config.tick_to_cancel_threshold)
+                      << " price="  << decision_data.price << " <= threshold price=" << (state.bid.price - trigger_config.tick_to_cancel_threshold)
                         << " -> triggering collection "  << std::hex << trigger_config.tick_to_cancel_collection_id << std::dec <<  std::endl;
 
             std::cout << "trigger collection #" << std::hex << decision_data.timestamp << "\n";
@@ -156,26 +203,28 @@ void Tick2cancel::trigger(hls::stream<InstrumentConfiguration::instrument_config
                                      decision_data.sequence_number, // Specify any 128 bit value that you want
                                      decision_data.source_id
                                      ); // Other Arguments don't have to be specified if not needed
+            events.trigger = 1;
+            events.trigger_latency = now - decision_data.arrival;
 
              // write notification in 1clk max
             user_dma_tick2cancel_notification notification;
-            fill_header(notification, AlgoCancelledOnBidSide);
+            fill_header(notification, AlgoCancelledOnBidSide, now);
             //applicative layer
             notification.sent_collection_id = trigger_config.tick_to_cancel_collection_id;
             notification.trade_summary_price = decision_data.price;
-            notification.book_top_level_price = book.bid_toplevel_price;
+            notification.book_top_level_price = state.bid.price;
             notification.instrument_id = decision_data.instr_id;
             notification.threshold = trigger_config.tick_to_cancel_threshold;
             notification.is_bid = 1;
+            notification.epoch = state.epoch;
+            notification.nxbus_arrival = decision_data.arrival;
 
-            tick2cancel_notification_out.write(notification); // write to the internal notification data bus
+            write_notification(tick2cancel_notification_out, notification_drops, pack_notification<Tick2cancel>(notification)); // write to the internal notification data bus
 
-        } else if ((book.ask_present) && trigger_config.enabled
-                   && (decision_data.price >= book.ask_toplevel_price + trigger_config.tick_to_cancel_threshold)
-                   && (trigger_config.tick_to_cancel_threshold != 0)) {
+        } else if (ask_triggered) {
 
             std::cout << "[TICK2CANCEL] trade summary above ask threshold ts=" << std::hex << decision_data.timestamp << " "
-                      << " price="  << decision_data.price << " >= threshold price=" << (book.bid_toplevel_price + trigger_config.tick_to_cancel_threshold)
+                      << " price="  << decision_data.price << " >= threshold price=" << (state.bid.price + trigger_config.tick_to_cancel_threshold)
                         << " -> triggering collection "  << std::hex << trigger_config.tick_to_cancel_collection_id << std::dec <<  std::endl;
             std::cout << "trigger collection #" << std::hex << decision_data.timestamp << "\n";
             ;
@@ -184,24 +233,59 @@ void Tick2cancel::trigger(hls::stream<InstrumentConfiguration::instrument_config
                                      decision_data.sequence_number, // Specify any 128 bit value that you want
                                      decision_data.source_id
                                      ); // Other Arguments don't have to be specified if not needed
+            events.trigger = 1;
+            events.trigger_latency = now - decision_data.arrival;
 
             // write notification in 1clk max
             user_dma_tick2cancel_notification notification;
-            fill_header(notification, AlgoCancelledOnAskSide);
+            fill_header(notification, AlgoCancelledOnAskSide, now);
             //applicative layer
             notification.sent_collection_id = trigger_config.tick_to_cancel_collection_id;
             notification.trade_summary_price = decision_data.price;
-            notification.book_top_level_price = book.ask_toplevel_price;
+            notification.book_top_level_price = state.ask.price;
             notification.instrument_id = decision_data.instr_id;
             notification.threshold = trigger_config.tick_to_cancel_threshold;
             notification.is_bid = 0;
-            tick2cancel_notification_out.write(notification);
+            notification.epoch = state.epoch;
+            notification.nxbus_arrival = decision_data.arrival;
+            write_notification(tick2cancel_notification_out, notification_drops, pack_notification<Tick2cancel>(notification));
 
         }
     }
 
+    report_notification_drops(tick2cancel_notification_drop_out, notification_drops);
+    report_events(events_out, pending_events, events);
 }
 
+/**
+ * @brief Tick2cancel::p_run Strategy processes, preprocess_nxbus() and trigger() joined by the context FIFO.
+ */
+void
+Tick2cancel::p_run(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+                 hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+                 hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+                 hls::stream<Books::read_book_data_request> & book_req_out,
+                 hls::stream<Books::book_entry> & books_in,
+                 hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                 hls::stream<InstrumentState::state_entry> & state_in,
+                 hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+                 hls::stream<notification_payload> & tick2cancel_notification_out,
+                 hls::stream<notification_drop> & tick2cancel_notification_drop_out,
+                 hls::stream<module_events_counts> & events_out,
+                 enyx::hls_tools::cycle_count now)
+{
+    #pragma HLS INLINE
+
+    // contextual data to take a trigger decision
+    static hls::stream<ContextData> t2c_context;
+    #pragma HLS STREAM variable=t2c_context depth=4
+
+    // process nxbus, make requests to books & instruments data
+    preprocess_nxbus(nxbus_axi_in, instrument_data_req, book_req_out, state_req_out, t2c_context, now);
+    // process response from book & instruments data, perform trigger
+    trigger(instrument_data_in, books_in, state_in, trigger_axibus_out, tick2cancel_notification_out, tick2cancel_notification_drop_out, events_out, t2c_context, now);
+} // p_run
+
 enyx::hfp::dma_user_channel_data_out
 Tick2cancel::notification_to_word(const user_dma_tick2cancel_notification& notif_in, int word_index)
 {
@@ -224,7 +308,9 @@ Tick2cancel::notification_to_word(const user_dma_tick2cancel_notification& notif
             out_word.data(127,96) = notif_in.instrument_id; //32
             out_word.data(95, 80) = notif_in.sent_collection_id; //16
             out_word.data(79, 72) = notif_in.is_bid; //8
-            out_word.data(72-1, 0) = 0;
+            out_word.data(71, 64) = notif_in.epoch; //8
+            out_word.data(63, 32) = notif_in.nxbus_arrival; //32
+            out_word.data(32-1, 0) = 0;
             out_word.last = 1; // last packet of the word sequence
             break;
         }
@@ -20,7 +20,12 @@
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
 #include "../include/enyx/md/hw/nxbus.hpp"
 #include "../include/enyx/md/hw/books.hpp"
+#include "../include/enyx/hls/clock.hpp"
+#include "parameters.hpp"
 #include "configuration.hpp"
+#include "instrument_state.hpp"
+#include "notifications.hpp"
+#include "module_events.hpp"
 
 namespace nxmd = enyx::md::hw;
 namespace nxoe  = enyx::oe::hwstrat;
@@ -36,6 +41,9 @@ namespace nxaccess_hw_algo {
 class Tick2cancel {
 public:
 
+    /// the cancels are sent before the other triggers
+    static const std::size_t decision_priority_class = CancelPriority;
+
     /**
      * @brief Data required for taking a decision, extracted from the market message.
      */
@@ -45,6 +53,7 @@ public:
         ap_uint<64>  sequence_number;       // sequence number of the market packet
         ap_uint<16>  source_id;             // multicast source id of the market packet
         ap_uint<24>  instr_id;              // instrument id
+        ap_uint<32>  arrival;               // cycle at which the trade summary was read
     };
 
     enum notifications_messages_types {
@@ -54,27 +63,61 @@ public:
 
     /// Tick 2 Cancel strategy
 
+    /// nxbus commands processed by preprocess_nxbus()
+    static bool
+    accepts_nxbus_opcode(ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        return opcode == nxmd::NXBUS_OPCODE_MISC_INPUT_PKT_INFO || opcode == nxmd::NXBUS_OPCODE_TRADE_SUMMARY;
+    }
+
     /**
-     * @brief Tick2cancel::preprocess_nxbus Process nxbus data and performs read request to Book & Instrument managers.
+     * @brief Tick2cancel::preprocess_nxbus Process nxbus data and performs read request to Book & Instrument managers,
+     * or to the instrument state memory when fused_instrument_state is set.
      */
     static void
     preprocess_nxbus( hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
                         hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
-                        hls::stream<enyx::md::hw::BooksData<2,256>::read_book_data_request> & book_req_out,
-                      hls::stream<ContextData> &decision_data_out);
+                        hls::stream<Books::read_book_data_request> & book_req_out,
+                        hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                      hls::stream<ContextData> &decision_data_out,
+                      enyx::hls_tools::cycle_count now);
 
     /**
      * @brief Tick2cancel::trigger Perform trigger action if algorithmic conditions are met.
      */
     static void
-    trigger(hls::stream<InstrumentConfiguration::instrument_configuration_data_item> & instrument_data_in,
-              hls::stream<enyx::md::hw::BooksData<2,256>::book_entry> & books_in,
+    trigger(hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+              hls::stream<Books::book_entry> & books_in,
+              hls::stream<InstrumentState::state_entry> & state_in,
               hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
-              hls::stream<user_dma_tick2cancel_notification>& tick2cancel_notification_out,
-            hls::stream<ContextData> &decision_data_in);
+              hls::stream<notification_payload> & tick2cancel_notification_out,
+              hls::stream<notification_drop> & tick2cancel_notification_drop_out,
+              hls::stream<module_events_counts> & events_out,
+            hls::stream<ContextData> &decision_data_in,
+            enyx::hls_tools::cycle_count now);
+
 
+    /**
+     * @brief Tick2cancel::p_run Strategy processes, preprocess_nxbus() and trigger() joined by the context FIFO.
+     * Instantiated by the strategies registry (see strategies.hpp).
+     */
+    static void
+    p_run(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+          hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+          hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+          hls::stream<Books::read_book_data_request> & book_req_out,
+          hls::stream<Books::book_entry> & books_in,
+          hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+          hls::stream<InstrumentState::state_entry> & state_in,
+          hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+          hls::stream<notification_payload> & tick2cancel_notification_out,
+          hls::stream<notification_drop> & tick2cancel_notification_drop_out,
+          hls::stream<module_events_counts> & events_out,
+          enyx::hls_tools::cycle_count now);
 
     static enyx::hfp::dma_user_channel_data_out
     notification_to_word(const user_dma_tick2cancel_notification& notif_in, int word_index);
+    static const int notification_word_count = 3; /// words written by notification_to_word()
 }; // class
 }}} // Namespaces
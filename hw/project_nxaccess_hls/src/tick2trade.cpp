@@ -16,6 +16,7 @@
 #include <cassert>
 
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
+#include "../include/enyx/hls/clock.hpp"
 #include "tick2trade.hpp"
 
 namespace enyx {
@@ -24,166 +25,248 @@ namespace nxaccess_hw_algo {
 
 using namespace enyx::oe::hwstrat;
 
-static void fill_header(user_dma_tick2trade_notification& notification, Tick2trade::notifications_messages_types message_type) {
+static void fill_header(user_dma_tick2trade_notification& notification, Tick2trade::notifications_messages_types message_type,
+                        ap_uint<32> emission) {
     notification.header.reserved = 0;
-    notification.header.timestamp = 0;
+    notification.header.timestamp = emission; // cycle at which the trigger is emitted
     notification.header.error = 0;
     notification.header.version = 1;
     notification.header.source = enyx::oe::nxaccess_hw_algo::Tick2trade;
     // we encode the side of the decision but it's only for showing that we have a message type that could be use
     // to transport several type of messages to host
     notification.header.msg_type = uint8_t(message_type);
-    notification.header.length = 0x0020;
+    notification.header.length = 0x0030;
 }
 
+/**
+ * @brief Tick2trade::preprocess_nxbus Process nxbus data and performs read request to Book & Instrument managers.
+ */
 void
-Tick2trade::p_algo( hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
-                        hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
-                        hls::stream<InstrumentConfiguration::instrument_configuration_data_item> & instrument_data_resp,
-                        hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
-                        hls::stream<user_dma_tick2trade_notification>& tick2trade_notification_out,
-                        hls::stream<enyx::md::hw::BooksData<2,256>::read_book_data_request> & book_req_out,
-                        hls::stream<enyx::md::hw::BooksData<2,256>::book_entry> & books_in)
+Tick2trade::preprocess_nxbus(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+                             hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+                             hls::stream<Books::read_book_data_request> & book_req_out,
+                             hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                             hls::stream<ContextData> & decision_data_out,
+                             enyx::hls_tools::cycle_count now)
 {
 
     #pragma HLS INLINE recursive
     #pragma HLS PIPELINE enable_flush
 
-    // Keep a version of the message to react on
-    // It would be better be to only keep the data required by the algorithm but it would impact code lisibility
-    static nxmd::nxbus pending_nxbus_data;
+    // Keep a copy of the data we need to react on in the 'trigger' function
+    static Tick2trade::ContextData decision_data;
 
-    static enum {READY,  // Waiting for nxbus trigger
-                 WAITING_FOR_INSTRUMENT_CONF_AND_BOOKS_DATA // Waiting for memory read
-                } current_state;
-    #pragma HLS RESET variable=current_state
+    // market packet of the next trade summaries, kept across the nxbus commands
+    static ap_uint<64> last_sequence_number = 0;
+    #pragma HLS RESET variable=last_sequence_number
+    static ap_uint<16> source_id = 0;
+    #pragma HLS RESET variable=source_id
 
     static bool start_of_nxbus_command = true;
     #pragma HLS RESET variable=start_of_nxbus_command
 
-    static uint64_t  last_sequence_number;
-    #pragma HLS RESET variable=last_sequence_number
-
-    static uint16_t  source_id;
-    #pragma HLS RESET variable=source_id
+    if (! nxbus_axi_in.empty()) {
+        nxmd::nxbus_axi const nxbus_data_in = nxbus_axi_in.read();
+        nxmd::nxbus nxbus_word_in = static_cast<nxmd::nxbus>(nxbus_data_in);
 
-    switch(current_state){
-    case READY: {
-        if (! nxbus_axi_in.empty()) {
-            nxmd::nxbus nxbus_word_in = static_cast<nxmd::nxbus>(nxbus_axi_in.read());
+        if(start_of_nxbus_command) {
 
-            if(start_of_nxbus_command) {
+            // User could do some instrument filtering for this strategy here but
+            // in this Demonstration it is considered that all the feed handler is
+            // configured to publish updates only on the desired instruments:
+            // if (not_subscribed(nxbus_word_in.instr_id) {
+            //     return ;
+            // }
 
-                // User could do some instrument filtering for this strategy here but
-                // in this Demonstration it is considered that all the feed handler is
-                // configured to publish updates only on the desired instruments:
-                // if (not_subscribed(nxbus_word_in.instr_id) {
-                //     return ;
-                // }
+            if (nxbus_word_in.opcode == nxmd::NXBUS_OPCODE_MISC_INPUT_PKT_INFO) {
 
-                if (nxbus_word_in.opcode == nxmd::NXBUS_OPCODE_MISC_INPUT_PKT_INFO) {
+                std::cout << "[TICK2TRADE] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
+                            << "Processing : Misc Input Info message  seqnum=" << nxbus_word_in.data0 << std::endl;
+                last_sequence_number = nxbus_word_in.data0;
+                source_id = nxbus_word_in.data1 & 0xFFFF;
 
-                    std::cout << "[TICK2TRADE] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
-                                << "Processing : Misc Input Info message  seqnum=" << nxbus_word_in.data0 << std::endl;
-                    last_sequence_number = nxbus_word_in.data0;
-                    source_id = nxbus_word_in.data1 & 0xFFFF;
+            } else if (nxbus_word_in.opcode == nxmd::NXBUS_OPCODE_TRADE_SUMMARY ) {
 
-                } else if (nxbus_word_in.opcode == nxmd::NXBUS_OPCODE_TRADE_SUMMARY ) {
+                std::cout << "[TICK2TRADE] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
+                            << "Processing : Trade Summary message price=" << nxbus_word_in.price << std::endl;
 
-                    std::cout << "[TICK2TRADE] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
-                                << "Processing : Trade Summary message price=" << nxbus_word_in.price << std::endl;
+                // prepare & transfer decision data to trigger()
+                decision_data.price = nxbus_word_in.price;
+                decision_data.buy_nsell = nxbus_word_in.buy_nsell;
+                decision_data.timestamp = nxbus_word_in.timestamp;
+                decision_data.instr_id = nxbus_word_in.instr_id;
+                decision_data.sequence_number = last_sequence_number;
+                decision_data.source_id = source_id;
+                decision_data.arrival = now;
+                decision_data_out.write(decision_data);
 
-                    pending_nxbus_data = nxbus_word_in; // Save current trade summary
-                    instrument_data_req.write(nxbus_word_in.instr_id); // Request the instrument's configuration
-                    current_state = WAITING_FOR_INSTRUMENT_CONF_AND_BOOKS_DATA; // Update state
-                    book_req_out.write(nxbus_word_in.instr_id);
+                // memories are indexed by the instrument slot, provided in the nxbus user field
+                if (fused_instrument_state) {
+                    state_req_out.write(nxbus_data_in.user); // Request the instrument's configuration & top of book
                 } else {
-                    // Here, we do nothing, as we don't know what to do
-                    // std::cout << "[trade] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
-                    // << "Ignored nxBus command : opcode=" << std::hex << nxbus_word_in.opcode  << std::endl;
+                    instrument_data_req.write(nxbus_data_in.user); // Request the instrument's configuration
+                    book_req_out.write(nxbus_data_in.user); // Request instrument's latest book to the book manager
                 }
+            } else {
+                // Here, we do nothing, as we don't know what to do
+                // std::cout << "[trade] [nxbus timestamp " << std::hex << nxbus_word_in.timestamp << "] "
+                // << "Ignored nxBus command : opcode=" << std::hex << nxbus_word_in.opcode  << std::endl;
             }
-
-            start_of_nxbus_command = nxbus_word_in.end_of_extra; // end_of_extra is set on the last word of a given command
-        } else {
-            //        std::cout << "nxbus input was empty" << std::endl;
         }
-        break;
+
+        start_of_nxbus_command = nxbus_word_in.end_of_extra; // end_of_extra is set on the last word of a given command
     }
-    case WAITING_FOR_INSTRUMENT_CONF_AND_BOOKS_DATA: {
-        // Waiting for the instrument's configuration & latest books data
-        if(!instrument_data_resp.empty() &&
-                !books_in.empty()) {
-            // Read conf data & books data
-            InstrumentConfiguration::instrument_configuration_data_item trigger_config = instrument_data_resp.read();
+} // preprocess_nxbus
+
+/**
+ * @brief Tick2trade::trigger Perform trigger action if algorithmic conditions are met.
+ */
+void
+Tick2trade::trigger(hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_resp,
+                    hls::stream<Books::book_entry> & books_in,
+                    hls::stream<InstrumentState::state_entry> & state_in,
+                    hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+                    hls::stream<notification_payload> & tick2trade_notification_out,
+                    hls::stream<notification_drop> & tick2trade_notification_drop_out,
+                    hls::stream<module_events_counts> & events_out,
+                    hls::stream<ContextData> & decision_data_in,
+                    enyx::hls_tools::cycle_count now)
+{
+
+    #pragma HLS INLINE recursive
+    #pragma HLS PIPELINE enable_flush
 
+    static notification_drop notification_drops = 0; /// notifications dropped, not reported yet
+    #pragma HLS RESET variable=notification_drops
+    static module_events_counts pending_events; /// events not sent to the statistics yet
+    #pragma HLS RESET variable=pending_events
+
+    module_events events;
+    events.decision_full = trigger_axibus_out.full();
+    events.notification_full = tick2trade_notification_out.full();
+
+    // Waiting for the instrument's configuration & latest books data
+    bool const state_ready = fused_instrument_state ? !state_in.empty()
+                                                    : (!instrument_data_resp.empty() && !books_in.empty());
+    // The decision waits for room in the trigger FIFO, so that the trigger is written on the cycle
+    // it is taken, without blocking: the latency reported runs up to the trigger emission.
+    if(state_ready && !decision_data_in.empty() && !trigger_axibus_out.full()) {
+        // Read conf data & books data
+        InstrumentConfiguration::instrument_configuration_data_item trigger_config;
+        ap_uint<8> epoch; // of the configuration
+        if (fused_instrument_state) {
+            // The top of book is unused, but could, depending on algorithm needs.
+            InstrumentState::state_entry const state = state_in.read();
+            trigger_config = state.config;
+            epoch = state.epoch;
+        } else {
+            InstrumentConfiguration::instrument_configuration_response const response = instrument_data_resp.read();
+            trigger_config = response.config;
+            epoch = response.epoch;
             // The status of the book is unused, but could, depending on algorithm needs.
-            enyx::md::hw::BooksData<2,256>::book_entry book = books_in.read();
-
-            // The Trade Summary message agressor side is on the buy side
-            if (( trigger_config.enabled
-                    && trigger_config.tick_to_trade_bid_price != 0) // Was this trade configured?
-                    && (pending_nxbus_data.price > trigger_config.tick_to_trade_bid_price) // Is the price better than the last TOB?
-                    && (pending_nxbus_data.buy_nsell == 1)) // Is the agressor side == buy
-                {
-
-                std::cout << "[TICK2TRADE] at nxbus timestamp " << std::hex << pending_nxbus_data.timestamp << " : "
-                          << " market price="  << pending_nxbus_data.price << " < trigger bid price=" << trigger_config.tick_to_trade_bid_price
-                          << " -> triggering collection "  << std::hex << trigger_config.tick_to_trade_bid_collection_id << std::dec <<  std::endl;
-
-                nxoe::trigger_collection(trigger_axibus_out,
-                                         trigger_config.tick_to_trade_bid_collection_id, // Collection to Trigger
-                                         last_sequence_number, // Specify any 128 bit value that you want
-                                         source_id,
-                                         'B' // the side that generated trigger
-                                         ); // Other Arguments don't have to be specified if not needed
-
-                user_dma_tick2trade_notification notification;
-                fill_header(notification, AlgoTriggeredOnBid);
-                //applicative layer
-                notification.sent_collection_id = trigger_config.tick_to_trade_bid_collection_id;
-                notification.trade_summary_price = pending_nxbus_data.price;
-                notification.instrument_id = pending_nxbus_data.instr_id;
-                notification.threshold_price = trigger_config.tick_to_trade_bid_price;
-                notification.is_bid = 0;
-                tick2trade_notification_out.write(notification); // write to the internal notification data bus
-
-            // The Trade Summary message agressor side is on the sell side
-            } else if ((  trigger_config.enabled
-                        && trigger_config.tick_to_trade_ask_price != 0) // Was this trade configured?
-                        && (pending_nxbus_data.price < trigger_config.tick_to_trade_ask_price) // Is the price better than the last TOB?
-                        &&  (pending_nxbus_data.buy_nsell == 0)) // Is the agressor side == sell
+            Books::book_entry book = books_in.read();
+        }
+
+        Tick2trade::ContextData const pending_nxbus_data = decision_data_in.read();
+
+        // The Trade Summary message agressor side is on the buy side
+        if (( trigger_config.enabled
+                && trigger_config.tick_to_trade_bid_price != 0) // Was this trade configured?
+                && (pending_nxbus_data.price > trigger_config.tick_to_trade_bid_price) // Is the price better than the last TOB?
+                && (pending_nxbus_data.buy_nsell == 1)) // Is the agressor side == buy
             {
-                std::cout << "[TICK2TRADE] at nxbus timestamp " << std::hex << pending_nxbus_data.timestamp << " : "
-                          << " market price="  << pending_nxbus_data.price << " > trigger ask price=" << trigger_config.tick_to_trade_ask_price
-                          << " -> triggering collection "  << std::hex << trigger_config.tick_to_trade_ask_collection_id << std::dec <<  std::endl;
-
-                nxoe::trigger_collection(trigger_axibus_out,
-                                         trigger_config.tick_to_trade_ask_collection_id, // Collection to Trigger
-                                         last_sequence_number, // Specify any 128 bit value that you want
-                                         source_id,
-                                         'S' // the side that generated trigger
-                                         ); // Other Arguments don't have to be specified if not needed
-
-                // write notification in 1clk max
-                user_dma_tick2trade_notification notification;
-                fill_header(notification, AlgoTriggeredOnAsk);
-                //applicative layer
-                notification.sent_collection_id = trigger_config.tick_to_trade_ask_collection_id;
-                notification.trade_summary_price = pending_nxbus_data.price;
-                notification.instrument_id = pending_nxbus_data.instr_id;
-                notification.threshold_price = trigger_config.tick_to_trade_ask_price;
-                notification.is_bid = 0;
-                tick2trade_notification_out.write(notification); // write to the internal notification data bus
-            }
 
-            // Whatever happen (trigger or not), we must change to IDLE, as we are ready
-            current_state = READY;
+            std::cout << "[TICK2TRADE] at nxbus timestamp " << std::hex << pending_nxbus_data.timestamp << " : "
+                      << " market price="  << pending_nxbus_data.price << " < trigger bid price=" << trigger_config.tick_to_trade_bid_price
+                      << " -> triggering collection "  << std::hex << trigger_config.tick_to_trade_bid_collection_id << std::dec <<  std::endl;
+
+            nxoe::trigger_collection(trigger_axibus_out,
+                                     trigger_config.tick_to_trade_bid_collection_id, // Collection to Trigger
+                                     pending_nxbus_data.sequence_number, // Specify any 128 bit value that you want
+                                     pending_nxbus_data.source_id,
+                                     'B' // the side that generated trigger
+                                     ); // Other Arguments don't have to be specified if not needed
+            events.trigger = 1;
+            events.trigger_latency = now - pending_nxbus_data.arrival;
+
+            user_dma_tick2trade_notification notification;
+            fill_header(notification, AlgoTriggeredOnBid, now);
+            //applicative layer
+            notification.sent_collection_id = trigger_config.tick_to_trade_bid_collection_id;
+            notification.trade_summary_price = pending_nxbus_data.price;
+            notification.instrument_id = pending_nxbus_data.instr_id;
+            notification.threshold_price = trigger_config.tick_to_trade_bid_price;
+            notification.is_bid = 0;
+            notification.epoch = epoch;
+            notification.nxbus_arrival = pending_nxbus_data.arrival;
+            write_notification(tick2trade_notification_out, notification_drops, pack_notification<Tick2trade>(notification)); // write to the internal notification data bus
+
+        // The Trade Summary message agressor side is on the sell side
+        } else if ((  trigger_config.enabled
+                    && trigger_config.tick_to_trade_ask_price != 0) // Was this trade configured?
+                    && (pending_nxbus_data.price < trigger_config.tick_to_trade_ask_price) // Is the price better than the last TOB?
+                    &&  (pending_nxbus_data.buy_nsell == 0)) // Is the agressor side == sell
+        {
+            std::cout << "[TICK2TRADE] at nxbus timestamp " << std::hex << pending_nxbus_data.timestamp << " : "
+                      << " market price="  << pending_nxbus_data.price << " > trigger ask price=" << trigger_config.tick_to_trade_ask_price
+                      << " -> triggering collection "  << std::hex << trigger_config.tick_to_trade_ask_collection_id << std::dec <<  std::endl;
+
+            nxoe::trigger_collection(trigger_axibus_out,
+                                     trigger_config.tick_to_trade_ask_collection_id, // Collection to Trigger
+                                     pending_nxbus_data.sequence_number, // Specify any 128 bit value that you want
+                                     pending_nxbus_data.source_id,
+                                     'S' // the side that generated trigger
+                                     ); // Other Arguments don't have to be specified if not needed
+            events.trigger = 1;
+            events.trigger_latency = now - pending_nxbus_data.arrival;
+
+            // write notification in 1clk max
+            user_dma_tick2trade_notification notification;
+            fill_header(notification, AlgoTriggeredOnAsk, now);
+            //applicative layer
+            notification.sent_collection_id = trigger_config.tick_to_trade_ask_collection_id;
+            notification.trade_summary_price = pending_nxbus_data.price;
+            notification.instrument_id = pending_nxbus_data.instr_id;
+            notification.threshold_price = trigger_config.tick_to_trade_ask_price;
+            notification.is_bid = 0;
+            notification.epoch = epoch;
+            notification.nxbus_arrival = pending_nxbus_data.arrival;
+            write_notification(tick2trade_notification_out, notification_drops, pack_notification<Tick2trade>(notification)); // write to the internal notification data bus
         }
-        break;
-    } //case WAITING_FOR_INSTRUMENT_DATA
-    } // switch
-} // p_algo
+    }
+
+    report_notification_drops(tick2trade_notification_drop_out, notification_drops);
+    report_events(events_out, pending_events, events);
+} // trigger
+
+/**
+ * @brief Tick2trade::p_run Strategy processes, preprocess_nxbus() and trigger() joined by the context FIFO.
+ */
+void
+Tick2trade::p_run(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+                hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+                hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+                hls::stream<Books::read_book_data_request> & book_req_out,
+                hls::stream<Books::book_entry> & books_in,
+                hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                hls::stream<InstrumentState::state_entry> & state_in,
+                hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+                hls::stream<notification_payload> & tick2trade_notification_out,
+                hls::stream<notification_drop> & tick2trade_notification_drop_out,
+                hls::stream<module_events_counts> & events_out,
+                enyx::hls_tools::cycle_count now)
+{
+    #pragma HLS INLINE
+
+    // contextual data to take a trigger decision
+    static hls::stream<ContextData> t2t_context;
+    #pragma HLS STREAM variable=t2t_context depth=4
+
+    // process nxbus, make requests to books & instruments data
+    preprocess_nxbus(nxbus_axi_in, instrument_data_req, book_req_out, state_req_out, t2t_context, now);
+    // process response from book & instruments data, perform trigger
+    trigger(instrument_data_in, books_in, state_in, trigger_axibus_out, tick2trade_notification_out, tick2trade_notification_drop_out, events_out, t2t_context, now);
+} // p_run
 
 enyx::hfp::dma_user_channel_data_out
 Tick2trade::notification_to_word(const user_dma_tick2trade_notification& notif_in, int word_index)
@@ -202,12 +285,18 @@ Tick2trade::notification_to_word(const user_dma_tick2trade_notification& notif_i
             out_word.data(63,32) = notif_in.instrument_id; // 32
             out_word.data(31, 16) = notif_in.sent_collection_id;
             out_word.data(15,8) = notif_in.is_bid;
-            out_word.data(8-1, 0) = 0;
+            out_word.data(7,0) = notif_in.epoch;
+            out_word.last = 0;
+            break;
+        }
+        case 3: {
+            out_word.data(127,96) = notif_in.nxbus_arrival; // 32
+            out_word.data(95,0) = 0;
             out_word.last = 1;
             break;
         }
         default:
-            assert(false && "Handling only 2 words for user_dma_tick2trade_notification encoding");
+            assert(false && "Handling only 3 words for user_dma_tick2trade_notification encoding");
 
     }
     return out_word;
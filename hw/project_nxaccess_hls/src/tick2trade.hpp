@@ -20,7 +20,12 @@
 #include "../include/enyx/oe/hwstrat/nxoe.hpp"
 #include "../include/enyx/md/hw/nxbus.hpp"
 #include "../include/enyx/md/hw/books.hpp"
+#include "../include/enyx/hls/clock.hpp"
+#include "parameters.hpp"
 #include "configuration.hpp"
+#include "instrument_state.hpp"
+#include "notifications.hpp"
+#include "module_events.hpp"
 #include "messages.hpp"
 
 namespace nxmd = enyx::md::hw;
@@ -31,29 +36,88 @@ namespace oe {
 namespace nxaccess_hw_algo {
 
 /**
- * @brief The Tick2trade strategy. This strategy is implemented with a 1-process approach.
- * This implementation does not ensure that one nxbus word can be consumed at each clock cycle.
- * Theorically, it could create backpressure on the feedhandler.
+ * @brief The Tick2trade strategy. This strategy is implemented with a 2-process approach
+ * that ensure it has not bandwith problem and can handle one nxbus word at each clock cycle.
  */
 class Tick2trade {
 public:
 
+    static const std::size_t decision_priority_class = TradePriority;
+
+    /**
+     * @brief Data required for taking a decision, extracted from the market message.
+     */
+    struct ContextData {
+        ap_uint<64>  price;                 // trade summary price
+        ap_uint<1>   buy_nsell;             // trade summary agressor side
+        ap_uint<32>  timestamp;             // nxbus timestamp of the trade summary
+        ap_uint<64>  sequence_number;       // sequence number of the market packet
+        ap_uint<16>  source_id;             // multicast source id of the market packet
+        ap_uint<24>  instr_id;              // instrument id
+        ap_uint<32>  arrival;               // cycle at which the trade summary was read
+    };
+
     enum notifications_messages_types {
         AlgoTriggeredOnAsk = 1, // When decision is taken for ask side
         AlgoTriggeredOnBid = 2, // When decision is taken for bid side
     };
-    
-    /// tick 2 trade strategy
+
+    /// Tick 2 Trade strategy
+
+    /// nxbus commands processed by preprocess_nxbus()
+    static bool
+    accepts_nxbus_opcode(ap_uint<nxmd::nxbus_meta_sizes::NXBUS_SIZE_OPCODE> const& opcode)
+    {
+        #pragma HLS INLINE
+        return opcode == nxmd::NXBUS_OPCODE_MISC_INPUT_PKT_INFO || opcode == nxmd::NXBUS_OPCODE_TRADE_SUMMARY;
+    }
+
+    /**
+     * @brief Tick2trade::preprocess_nxbus Process nxbus data and performs read request to Book & Instrument managers,
+     * or to the instrument state memory when fused_instrument_state is set.
+     */
+    static void
+    preprocess_nxbus(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+                     hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+                     hls::stream<Books::read_book_data_request> & book_req_out,
+                     hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+                     hls::stream<ContextData> & decision_data_out,
+                     enyx::hls_tools::cycle_count now);
+
+    /**
+     * @brief Tick2trade::trigger Perform trigger action if algorithmic conditions are met.
+     */
+    static void
+    trigger(hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+            hls::stream<Books::book_entry> & books_in,
+            hls::stream<InstrumentState::state_entry> & state_in,
+            hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+            hls::stream<notification_payload> & tick2trade_notification_out,
+            hls::stream<notification_drop> & tick2trade_notification_drop_out,
+            hls::stream<module_events_counts> & events_out,
+            hls::stream<ContextData> & decision_data_in,
+            enyx::hls_tools::cycle_count now);
+
+    /**
+     * @brief Tick2trade::p_run Strategy processes, preprocess_nxbus() and trigger() joined by the context FIFO.
+     * Instantiated by the strategies registry (see strategies.hpp).
+     */
     static void
-    p_algo(hls::stream<nxmd::nxbus_axi> & nxbus_in,
-                 hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
-                 hls::stream<InstrumentConfiguration::instrument_configuration_data_item> & instrument_data_resp,
-                 hls::stream<nxoe::trigger_command_axi> & trigger_bus_out,
-                 hls::stream<user_dma_tick2trade_notification>& tick2trade_notification_out,
-                 hls::stream<enyx::md::hw::BooksData<2,256>::read_book_data_request> & book_req_out,
-                 hls::stream<enyx::md::hw::BooksData<2,256>::book_entry> & books_in);
+    p_run(hls::stream<nxmd::nxbus_axi> & nxbus_axi_in,
+          hls::stream<InstrumentConfiguration::read_instrument_data_request> & instrument_data_req,
+          hls::stream<InstrumentConfiguration::instrument_configuration_response> & instrument_data_in,
+          hls::stream<Books::read_book_data_request> & book_req_out,
+          hls::stream<Books::book_entry> & books_in,
+          hls::stream<InstrumentState::read_instrument_state_request> & state_req_out,
+          hls::stream<InstrumentState::state_entry> & state_in,
+          hls::stream<nxoe::trigger_command_axi> & trigger_axibus_out,
+          hls::stream<notification_payload> & tick2trade_notification_out,
+          hls::stream<notification_drop> & tick2trade_notification_drop_out,
+          hls::stream<module_events_counts> & events_out,
+          enyx::hls_tools::cycle_count now);
 
     static enyx::hfp::dma_user_channel_data_out
     notification_to_word(const user_dma_tick2trade_notification& notif_in, int word_index);
+    static const int notification_word_count = 3; /// words written by notification_to_word()
 }; // class
 }}} // Namespaces
@@ -24,10 +24,12 @@
 // nxAccess HLS algo demo
 #include "top.hpp"
 #include "configuration.hpp"
-#include "tick2cancel.hpp"
-#include "tick2trade.hpp"
+#include "strategies.hpp"
 #include "notifications.hpp"
 #include "tcp_consumer.hpp"
+#include "statistics.hpp"
+#include "instrument_state.hpp"
+#include "parameters.hpp"
 
 #include "messages.hpp"
 
@@ -38,23 +40,18 @@ namespace nxmd = enyx::md::hw;
 namespace nxoe = enyx::oe::hwstrat;
 
 // Modification of these constant will change the whole core behavior
-// the strategy can only handle instrument_count instruments at present
-static const std::size_t instrument_count = 256;
-// number of trading strategies
-static const std::size_t strategy_count = 2;
-
-/// Bus indexes of the algorithms strategies
-enum DecisionBusIndex {
-    Tick2Cancel = 0,
-    Tick2Trade = 1
-};
+// core wide parameters (instrument count, books depth, strategies registry) are in parameters.hpp
+using algo::strategy_count;
+using algo::nxbus_bus_count;
+using algo::decision_bus_count;
 
 void
 algorithm_entrypoint(hls::stream<enyx::md::hw::nxbus_axi> & nxbus_in,
                      hls::stream<enyx::hfp::dma_user_channel_data_in>& user_dma_channel_data_in,
                      hls::stream<enyx::hfp::dma_user_channel_data_out>& user_dma_channel_data_out,
                      hls::stream<enyx::oe::hwstrat::trigger_command_axi> & trigger_bus_out,
-                     hls::stream<enyx::oe::hwstrat::tcp_reply_payload> & tcp_replies_in)
+                     hls::stream<enyx::oe::hwstrat::tcp_reply_payload> & tcp_replies_in,
+                     enyx::hls_tools::cycle_count cycle)
 {
 
 #pragma HLS INTERFACE ap_ctrl_none port=return
@@ -65,6 +62,8 @@ algorithm_entrypoint(hls::stream<enyx::md::hw::nxbus_axi> & nxbus_in,
 #pragma HLS INTERFACE axis port=user_dma_channel_data_in
 #pragma HLS INTERFACE axis port=user_dma_channel_data_out
 #pragma HLS INTERFACE axis port=tcp_replies_in
+// sampled by every process, without any handshake
+#pragma HLS INTERFACE ap_none port=cycle
 
 //#pragma HLS INTERFACE register port=counter_tcpreplies_rx
 #pragma HLS DATAFLOW
@@ -74,101 +73,166 @@ algorithm_entrypoint(hls::stream<enyx::md::hw::nxbus_axi> & nxbus_in,
    static hls::stream<algo::InstrumentConfiguration::read_instrument_data_request> instrument_read_bus[strategy_count]; //instrument read request bus
 #pragma HLS STREAM variable=instrument_read_bus depth=1
 
-   static hls::stream<algo::InstrumentConfiguration::instrument_configuration_data_item> instrument_read_responses[strategy_count]; //instrument response bus
+   static hls::stream<algo::InstrumentConfiguration::instrument_configuration_response> instrument_read_responses[strategy_count]; //instrument response bus
 #pragma HLS STREAM variable=instrument_read_responses depth=1
 
+   // Instrument State (configuration & top of book) Access Buses
+   static hls::stream<algo::InstrumentState::read_instrument_state_request> instrument_state_read_bus[strategy_count]; //instrument state read request bus
+#pragma HLS STREAM variable=instrument_state_read_bus depth=1
+   static hls::stream<algo::InstrumentState::state_entry> instrument_state_responses[strategy_count]; //instrument state response bus
+#pragma HLS STREAM variable=instrument_state_responses depth=1
+   static hls::stream<algo::InstrumentConfiguration::instrument_configuration_update> instrument_configuration_updates; //configuration updates to the configuration memory
+#pragma HLS STREAM variable=instrument_configuration_updates depth=1
+   static hls::stream<algo::InstrumentConfiguration::instrument_configuration_update> instrument_state_configuration_updates; //configuration updates to the instrument state
+#pragma HLS STREAM variable=instrument_state_configuration_updates depth=1
+   static hls::stream<algo::Books::top_of_book_update> top_of_book_updates; //top of book updates to the instrument state
+#pragma HLS STREAM variable=top_of_book_updates depth=1
+
+   // Instrument id to instrument slot mapping, updated when instruments are configured
+   static hls::stream<algo::InstrumentMap::map_update> instrument_map_updates;
+#pragma HLS STREAM variable=instrument_map_updates depth=1
+
+   static hls::stream<nxmd::nxbus_axi> mapped_nxbus; // nxbus with the instrument slot in user field
+#pragma HLS STREAM variable=mapped_nxbus depth=1
+
+   algo::InstrumentMap::p_map_nxbus(nxbus_in, instrument_map_updates, mapped_nxbus);
+
    // Input Market Data Distribution to the various functions
-   static hls::stream<nxmd::nxbus_axi> nxbus_outputs[strategy_count+1]; // demuxed/duplicated outputs to (consumer) decision blocks
+   static hls::stream<nxmd::nxbus_axi> nxbus_outputs[nxbus_bus_count]; // demuxed/duplicated outputs to (consumer) decision blocks
 #pragma HLS STREAM variable=nxbus_outputs depth=1
 
    // disable warning in GCC for anonymous structs, like 'nxbus_to_decision'
    #pragma GCC diagnostic ignored "-Wlocal-type-template-args"
    struct nxbus_to_decision {} ;
-   typedef enyx::hls_tools::demuxer<nxbus_to_decision, strategy_count+1, nxmd::nxbus_axi>  nxbus_to_decision_demuxer_type; // create demuxer/duplicate type
-   nxbus_to_decision_demuxer_type::p_demux(nxbus_in, nxbus_outputs); // effectively demux/duplicate
+   typedef enyx::hls_tools::command_demuxer<nxbus_to_decision, nxbus_bus_count, nxmd::nxbus_axi,
+                                            algo::nxbus_filters<>, nxmd::nxbus_command_traits>  nxbus_to_decision_demuxer_type; // create demuxer type
+   static hls::stream<ap_uint<nxbus_bus_count> > nxbus_full; // outputs full, when the demuxer waits for them
+#pragma HLS STREAM variable=nxbus_full depth=2
+   nxbus_to_decision_demuxer_type::p_demux(mapped_nxbus, nxbus_outputs, nxbus_full); // effectively demux, each output getting the commands it processes
 
-   // Mux/arbitrate the order trigger commands from the various Algorithms
+   // Mux/arbitrate the order trigger commands from the various Algorithms, by priority class
    struct decisions_to_trigger {};
-   typedef enyx::hls_tools::arbiter<decisions_to_trigger, strategy_count+2, nxoe::trigger_command_axi>  decisions_to_trigger_arbiter_type; // create arbiter type
+   typedef enyx::hls_tools::priority_arbiter<decisions_to_trigger, decision_bus_count, nxoe::trigger_command_axi,
+                                             algo::decision_priorities<> >  decisions_to_trigger_arbiter_type; // create arbiter type
 
-   static hls::stream<nxoe::trigger_command_axi> decisions_ouputs[strategy_count+2]; // duplicated outputs, consumed by decision blocks
+   static hls::stream<nxoe::trigger_command_axi> decisions_ouputs[decision_bus_count]; // duplicated outputs, consumed by decision blocks
 #pragma HLS STREAM variable=decisions_ouputs depth=1
 
    decisions_to_trigger_arbiter_type::p_arbitrate(decisions_ouputs, trigger_bus_out);
 
    // Top of Book Read & Write Buses
-   static hls::stream<nxmd::BooksData<strategy_count,instrument_count>::halfbook_entry_update_request> book_update_bus; /// transport books updates
-   static hls::stream<nxmd::BooksData<strategy_count,instrument_count>::read_book_data_request> read_book_request_bus[strategy_count]; /// transports read book requests
-   static hls::stream<nxmd::BooksData<strategy_count,instrument_count>::book_entry> books[strategy_count]; /// transport read books entries
+   static hls::stream<algo::Books::halfbook_entry_update_request> book_update_bus; /// transport books updates
+   static hls::stream<algo::Books::halfbook_entry_update_request> book_update_sources[2]; /// books updates from price level & order level commands
+   static hls::stream<algo::Books::read_book_data_request> read_book_request_bus[strategy_count]; /// transports read book requests
+   static hls::stream<algo::Books::book_entry> books[strategy_count]; /// transport read books entries
 #pragma HLS STREAM variable=book_update_bus depth=1
+#pragma HLS STREAM variable=book_update_sources depth=1
 #pragma HLS STREAM variable=read_book_request_bus depth=1
 #pragma HLS STREAM variable=books depth=1
 
-   // contextual data to take a trigger decision
-   static hls::stream<enyx::oe::nxaccess_hw_algo::Tick2cancel::ContextData> t2c_context;
-
    // data buses for notifications; as notifying to the DMA can be a long process, we set 32 items as depth for these FIFOs
-   static hls::stream<algo::user_dma_update_instrument_configuration_ack> config_to_notifs;
-   #pragma HLS STREAM variable=config_to_notifs depth=4
-   static hls::stream<algo::user_dma_tick2trade_notification> tick2trade_to_notifs;
-   #pragma HLS STREAM variable=tick2trade_to_notifs depth=4
-   static hls::stream<algo::user_dma_tick2cancel_notification> tick2cancel_to_notifs;
-   #pragma HLS STREAM variable=tick2cancel_to_notifs depth=4
-   static hls::stream<algo::user_dma_tcp_consumer_notification> tcp_to_notifs;
-   #pragma HLS STREAM variable=tcp_to_notifs depth=4
-
-
-   /// Tick to Cancel Algorithm
-   // process nxbus, make requests to books & instruments data
-   enyx::oe::nxaccess_hw_algo::Tick2cancel::preprocess_nxbus(nxbus_outputs[Tick2Cancel],
-                                                             instrument_read_bus[Tick2Cancel],
-                                                             read_book_request_bus[Tick2Cancel],
-                                                             t2c_context);
-   // process response from book & instruments data, perform trigger
-   enyx::oe::nxaccess_hw_algo::Tick2cancel::trigger(instrument_read_responses[Tick2Cancel],
-                                                    books[Tick2Cancel],
-                                                    decisions_ouputs[Tick2Cancel],
-                                                    tick2cancel_to_notifs,
-                                                    t2c_context);
-
-
-   // Price Collar Algorithm
-   enyx::oe::nxaccess_hw_algo::Tick2trade::p_algo(nxbus_outputs[1],
-                           instrument_read_bus[1],
-                           instrument_read_responses[1],
-                           decisions_ouputs[1],
-                           tick2trade_to_notifs,
-                           read_book_request_bus[1],
-                           books[1]);
+   static hls::stream<algo::notification_payload> notifications[algo::notification_bus_count];
+   #pragma HLS STREAM variable=notifications depth=4
+   // the producers but the configuration never wait for a notification FIFO, they report the notifications dropped instead
+   static hls::stream<algo::notification_drop> notification_drops[algo::notification_producer_count];
+   #pragma HLS STREAM variable=notification_drops depth=1
+   // notifications status requests of the software, answered by the notifications monitor
+   static hls::stream<algo::notifications_status_request> notifications_status_requests;
+   #pragma HLS STREAM variable=notifications_status_requests depth=1
+   // events of the trigger producers, counted by the statistics
+   static hls::stream<algo::module_events_counts> statistics_events[algo::statistics_module_count];
+   #pragma HLS STREAM variable=statistics_events depth=2
+   // latency histograms read requests of the software, answered by the statistics
+   static hls::stream<algo::latency_histogram_request> latency_histogram_requests;
+   #pragma HLS STREAM variable=latency_histogram_requests depth=1
+   // counters read requests of the software, answered by the statistics
+   static hls::stream<algo::statistics_request> statistics_requests;
+   #pragma HLS STREAM variable=statistics_requests depth=1
+
+
+   /// Trading strategies, one instance per registry entry, each one on its own buses
+   algo::strategies_instantiator<algo::strategies>::p_run(nxbus_outputs,
+                                                         instrument_read_bus,
+                                                         instrument_read_responses,
+                                                         read_book_request_bus,
+                                                         books,
+                                                         instrument_state_read_bus,
+                                                         instrument_state_responses,
+                                                         decisions_ouputs,
+                                                         notifications,
+                                                         notification_drops,
+                                                         statistics_events,
+                                                         cycle);
 
 
     // Book Update Process: uses nxbus, and update book memory
-    enyx::md::hw::BooksData<strategy_count,instrument_count>::p_book_updates(nxbus_outputs[2],
-                                                                            book_update_bus);
+    algo::Books::p_book_updates(nxbus_outputs[algo::nxbus_bus_book_updates],
+                                book_update_sources[0]);
+
+    // Order level Book Update Process: tracks the orders, and update book memory
+    algo::OrderBook::p_order_updates(nxbus_outputs[algo::nxbus_bus_order_updates],
+                                     book_update_sources[1]);
+
+    // Merge the books updates
+    algo::Books::p_merge_updates(book_update_sources, book_update_bus);
 
     // Dispatch book memory to the various strategies
-    enyx::md::hw::BooksData<strategy_count,instrument_count>::p_book_requests(book_update_bus,
-                                                                            read_book_request_bus,
-                                                                            books);
+    algo::Books::p_book_requests(book_update_bus,
+                                 read_book_request_bus,
+                                 books,
+                                 top_of_book_updates);
 
     // Store instrument configuration received from SW & provide it to the other functions
     algo::InstrumentConfiguration::p_handle_instrument_configuration(user_dma_channel_data_in,
-                                                                       instrument_read_bus,
-                                                                       instrument_read_responses,
-                                                                       config_to_notifs,
-                                                                       decisions_ouputs[strategy_count+1]);
+                                                                       notifications[algo::notification_bus_configuration],
+                                                                       statistics_events[algo::statistics_module_configuration],
+                                                                       decisions_ouputs[algo::decision_bus_software_trigger],
+                                                                       instrument_map_updates,
+                                                                       instrument_configuration_updates,
+                                                                       latency_histogram_requests,
+                                                                       statistics_requests,
+                                                                       notifications_status_requests,
+                                                                       cycle);
+
+    // Serve the instrument configuration to the strategies, every cycle
+    algo::InstrumentConfiguration::p_serve_instrument_configuration(instrument_configuration_updates,
+                                                                     instrument_read_bus,
+                                                                     instrument_read_responses,
+                                                                     instrument_state_configuration_updates);
+
+    // Serve the instrument configuration & top of book to the strategies in a single read
+    algo::InstrumentState::p_serve(instrument_state_configuration_updates,
+                                   top_of_book_updates,
+                                   instrument_state_read_bus,
+                                   instrument_state_responses);
 
      // Handle notifications from workers to DMA
-     algo::Notifications::p_broadcast_notifications(tick2cancel_to_notifs,
-                                                   tick2trade_to_notifs,
-                                                   config_to_notifs,
-                                                   tcp_to_notifs,
+     algo::Notifications::p_broadcast_notifications(notifications,
                                                    user_dma_channel_data_out);
 
+     // Report the notifications dropped, periodically & on request
+     algo::Notifications::p_monitor_notifications(notification_drops,
+                                                  notifications_status_requests,
+                                                  notifications[algo::notification_bus_status],
+                                                  cycle);
+
+     // Count the market data, the triggers & the back pressure, report them periodically & on request
+     algo::Statistics::p_collect(nxbus_outputs[algo::nxbus_bus_statistics],
+                                 nxbus_full,
+                                 statistics_events,
+                                 latency_histogram_requests,
+                                 statistics_requests,
+                                 notifications[algo::notification_bus_statistics],
+                                 notification_drops[algo::notification_producer_statistics],
+                                 cycle);
+
 
      // Consumes TCP input data, and trigger
      enyx::oe::nxaccess_hw_algo::TcpConsumer::p_consume_tcp(
         tcp_replies_in,
-        tcp_to_notifs,
-        decisions_ouputs[strategy_count]);
+        notifications[algo::notification_bus_tcp_consumer],
+        notification_drops[algo::notification_producer_tcp_consumer],
+        statistics_events[algo::statistics_module_tcp_consumer],
+        decisions_ouputs[algo::decision_bus_tcp_consumer],
+        cycle);
 }
@@ -21,11 +21,15 @@
 #include "../include/enyx/hfp/hfp.hpp"
 
 #include "../include/enyx/oe/hwstrat/tcp.hpp"
+#include "../include/enyx/hls/clock.hpp"
 
-/// Implements the main process of the decision logic
+/// Implements the main process of the decision logic.
+/// cycle is the count of a free-running counter of the core clock, the time base of the timestamps
+/// (see enyx::hls_tools::cycle_count).
 void
 algorithm_entrypoint(hls::stream<enyx::md::hw::nxbus_axi> & nxbus_in,
                      hls::stream<enyx::hfp::dma_user_channel_data_in>& user_dma_channel_data_in,
                      hls::stream<enyx::hfp::dma_user_channel_data_out>& user_dma_channel_data_out,
                      hls::stream<enyx::oe::hwstrat::trigger_command_axi> & trigger_bus_out,
-                     hls::stream<enyx::oe::hwstrat::tcp_reply_payload> & tcp_replies_in);
+                     hls::stream<enyx::oe::hwstrat::tcp_reply_payload> & tcp_replies_in,
+                     enyx::hls_tools::cycle_count cycle);
@@ -96,6 +96,21 @@ struct OrderHandler : public oe::hwstrat::demo::Handler {
         LOG_ME(NX_INFO, "[%s] ConfAck: %s", LogPrefix, toStr(ack).c_str());
     }
 
+    virtual void
+    on(const hwstrat::demo::InstrumentConfigurationBatchAckMessage & ack) override {
+        LOG_ME(NX_INFO, "[%s] ConfBatchAck: %s", LogPrefix, toStr(ack).c_str());
+    }
+
+    virtual void
+    on(const hwstrat::demo::InstrumentConfigurationCoalescedAckMessage & ack) override {
+        LOG_ME(NX_INFO, "[%s] ConfCoalescedAck: %s", LogPrefix, toStr(ack).c_str());
+    }
+
+    virtual void
+    on(const hwstrat::demo::CommitEpochAckMessage & ack) override {
+        LOG_ME(NX_INFO, "[%s] CommitEpochAck: %s", LogPrefix, toStr(ack).c_str());
+    }
+
     virtual void
     on(const hwstrat::demo::TickToCancelNotificationMessage& notif) override {
         LOG_ME(NX_INFO, "[%s] TickToCancel: %s", LogPrefix, toStr(notif).c_str());
@@ -105,6 +120,21 @@ struct OrderHandler : public oe::hwstrat::demo::Handler {
     on(const hwstrat::demo::TickToTradeNotificationMessage& notif) override {
         LOG_ME(NX_INFO, "[%s] TickToTrade: %s", LogPrefix, toStr(notif).c_str());
     }
+
+    virtual void
+    on(const hwstrat::demo::NotificationsStatusMessage& status) override {
+        LOG_ME(NX_INFO, "[%s] NotificationsStatus: %s", LogPrefix, toStr(status).c_str());
+    }
+
+    virtual void
+    on(const hwstrat::demo::StatisticsCountersMessage& statistics) override {
+        LOG_ME(NX_INFO, "[%s] StatisticsCounters: %s", LogPrefix, toStr(statistics).c_str());
+    }
+
+    virtual void
+    on(const hwstrat::demo::LatencyHistogramMessage& histogram) override {
+        LOG_ME(NX_INFO, "[%s] LatencyHistogram: %s", LogPrefix, toStr(histogram).c_str());
+    }
 };
 
 } // namespace example
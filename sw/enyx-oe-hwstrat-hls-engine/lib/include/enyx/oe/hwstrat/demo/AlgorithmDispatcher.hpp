@@ -13,9 +13,14 @@ struct AlgorithmDispatcher
 {
     AlgorithmDispatcher(Handler & handler) : handler_(handler) {}
 
+    /// Dispatches the messages of a DMA packet, which may hold several
+    /// messages when the FPGA aggregates its notifications.
     void operator()(const uint8_t * data, uint32_t size) ;
 
     Handler & handler_;
+
+private:
+    void dispatch(const uint8_t * data) ;
 };
 
 } // namespace demo
@@ -17,6 +17,7 @@
 
 #include <enyx/oe/hwstrat/demo/Protocol.hpp>
 #include <enyx/oe/hwstrat/demo/AlgorithmDispatcher.hpp>
+#include <enyx/oe/hwstrat/demo/TriggerTemplate.hpp>
 
 namespace enyx {
 namespace oe {
@@ -68,15 +69,72 @@ public:
     /**
      *  @brief Send configuration to FPGA
      *  @param update The update to apply.
+     *  @param ack The acknowledgement requested. Use ConfigurationAck::Coalesced
+     *         for mass reconfiguration, the last configuration being sent with
+     *         ConfigurationAck::CoalescedFlush: the FPGA has no timeout, the
+     *         coalesced ack of the last instrument ids window is held until a
+     *         configuration requests it.
      *  @return The status of the call.
      */
     std::error_code
-    sendConfiguration(const InstrumentConfiguration & update);
+    sendConfiguration(const InstrumentConfiguration & update,
+                      ConfigurationAck ack = ConfigurationAck::Immediate);
+
+    /**
+     *  @brief Send configurations to FPGA in batches of up to
+     *         MAX_CONFIGURATION_BATCH_SIZE configurations, each batch being
+     *         acknowledged by a single InstrumentConfigurationBatchAckMessage.
+     *  @param updates The updates to apply.
+     *  @param bank The configuration bank written. The configurations written
+     *         to the shadow bank are used once committed with commitEpoch().
+     *  @return The status of the call.
+     */
+    std::error_code
+    sendConfigurations(const std::vector<InstrumentConfiguration> & updates,
+                       ConfigurationBank bank = ConfigurationBank::Active);
+
+    /**
+     *  @brief Swap the active and shadow configuration banks: all the
+     *         configurations of the shadow bank are used at once.
+     *         The configurations sent to the active bank since the previous
+     *         commit are kept: the FPGA mirrors them into the shadow bank,
+     *         replacing the configuration staged there for their instrument.
+     *  @param epoch The id of the new epoch, reported by the notifications.
+     *  @return The status of the call.
+     */
+    std::error_code
+    commitEpoch(uint8_t epoch);
+
+    /**
+     *  @brief Request the trigger latency histogram of a module, sent back
+     *         in LatencyHistogramMessage pages.
+     *  @param module The module, see StatisticsPages::Modules for their order.
+     *  @param reset Whether the histogram is reset once read.
+     *  @return The status of the call.
+     */
+    std::error_code
+    readLatencyHistogram(uint8_t module, bool reset);
+
+    /**
+     *  @brief Request a NotificationsStatusMessage at once, rather than
+     *         waiting for the periodic one.
+     *  @return The status of the call.
+     */
+    std::error_code
+    readNotificationsStatus();
+
+    /**
+     *  @brief Request the StatisticsCountersMessage pages at once, rather
+     *         than waiting for the periodic ones.
+     *  @return The status of the call.
+     */
+    std::error_code
+    readStatistics();
 
 
     /**
      * @brief Trigger an collection using the sandbox with some arguments.
-     *        Depending on the number of argument, the message sent will have a different size.
+     *        Only the arguments present are sent (see CompactTriggerWithArgsMessage).
      *
      * @param collection_id Id of the collection to trigger
      * @param arg0 First argument of the trigger. Should be a valid buffer with a size between 1 and 16.
@@ -104,12 +162,31 @@ public:
     std::error_code
     trigger(const TriggerWithArgsMessage& to_send);
 
+    /** @brief same as trigger using a compact message, sending only the arguments present */
+    std::error_code
+    trigger(const CompactTriggerWithArgsMessage& to_send);
+
+    /**
+     * @brief Trigger a collection from a registered template, as patched:
+     *        the message is sent as is, without any copy.
+     *
+     * @param handle Handle of the template, returned by triggerTemplates().add().
+     * @return std::error_code An error code.  User shall retry when error code is [ std::errc::resource_unavailable_try_again ].
+     */
+    std::error_code
+    trigger(TriggerTemplateHandle handle);
+
+    /** @brief The trigger templates, to register and patch them. */
+    TriggerTemplates&
+    triggerTemplates() { return trigger_templates_; }
+
 private:
     enyx::hw::accelerator accelerator_;
     enyx::hw::c2a_stream c2a_stream_;
     enyx::hw::a2c_stream a2c_stream_;
     AlgorithmDispatcher dispatcher_;
     enyx::hw::a2c_stream::poller<std::reference_wrapper<AlgorithmDispatcher>> poller_;
+    TriggerTemplates trigger_templates_;
 };
 
 } // namespace demo
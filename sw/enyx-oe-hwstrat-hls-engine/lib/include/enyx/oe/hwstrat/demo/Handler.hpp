@@ -43,6 +43,30 @@ public:
      */
     virtual void on(const InstrumentConfigurationAckMessage& ack) = 0;
 
+    /**
+     *  @brief Called upon reception of the acknowledgement of a configurations
+     *  batch being applied.
+     *
+     *  @param ack The summary of the batch.
+     */
+    virtual void on(const InstrumentConfigurationBatchAckMessage& ack) = 0;
+
+    /**
+     *  @brief Called upon reception of the coalesced acknowledgement of
+     *  configurations being applied.
+     *
+     *  @param ack The configurations being acknowledged.
+     */
+    virtual void on(const InstrumentConfigurationCoalescedAckMessage& ack) = 0;
+
+    /**
+     *  @brief Called upon reception of the acknowledgement of a configuration
+     *  epoch commit.
+     *
+     *  @param ack The epoch now active.
+     */
+    virtual void on(const CommitEpochAckMessage& ack) = 0;
+
     /**
      *  @brief Called upon reception of an acknowledgement of a tick to cancel trigger
      *         being fired.
@@ -60,6 +84,28 @@ public:
      */
     virtual void on(const TickToTradeNotificationMessage& notif) = 0;
 
+    /**
+     *  @brief Called upon reception of the periodic status of the notifications.
+     *
+     *  @param status The notifications dropped by the FPGA.
+     */
+    virtual void on(const NotificationsStatusMessage& status) = 0;
+
+    /**
+     *  @brief Called upon reception of a page of the periodic statistics.
+     *
+     *  @param statistics The FPGA activity counters of the page.
+     */
+    virtual void on(const StatisticsCountersMessage& statistics) = 0;
+
+    /**
+     *  @brief Called upon reception of a page of a trigger latency histogram,
+     *         requested by AlgorithmDriver::readLatencyHistogram().
+     *
+     *  @param histogram The buckets of the page.
+     */
+    virtual void on(const LatencyHistogramMessage& histogram) = 0;
+
     /// @}
 
     /**
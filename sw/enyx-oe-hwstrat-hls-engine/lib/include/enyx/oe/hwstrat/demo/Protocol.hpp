@@ -19,7 +19,11 @@ constexpr uint16_t UNALLOCATED_ID = UINT16_MAX;
 constexpr uint8_t DEFAULT_ACK = 1; // Acknowledge requested
 constexpr size_t TRIGGER_ARG_SIZE = 16;
 constexpr size_t TRIGGER_NB_ARG = 5;
-constexpr size_t MAX_INSTR = 256;
+constexpr size_t MAX_INSTR = 4096 - 1; // hardware instrument slots, slot 0 is reserved
+constexpr size_t MAX_CONFIGURATION_BATCH_SIZE = 256; // instrument configurations per batch message
+constexpr size_t COALESCED_ACK_WINDOW = 64; // instrument ids reported by a coalesced ack
+constexpr size_t MAX_NOTIFICATION_BUSES = 8; // notification buses reported by a notifications status
+constexpr size_t STATISTICS_COUNTERS_PER_PAGE = 8; // counters of a statistics counters message
 constexpr uint8_t APPLICATION_VERSION = 1;
 
 using TriggerArg = std::array<uint8_t, TRIGGER_ARG_SIZE>;
@@ -29,7 +33,47 @@ enum class ModulesIds : uint8_t {
     InstrumentDataConfiguration = 8, // Module that handle instrument configuration, see configuration.hpp
     SoftwareTrigger = 9, // Not implemented yet, reserved for module handling trigger from software. // Not present in demonstration
     TickToCancel = 10,   // tick2cancel strategy
-    TickToTrade = 11 // tick2trade strategy
+    TickToTrade = 11, // tick2trade strategy
+    NotificationsStatus = 12, // periodic status of the FPGA notifications
+    StatisticsCounters = 13 // periodic FPGA activity counters
+};
+
+/// Message types of the InstrumentDataConfiguration module
+enum class InstrumentConfigurationMessageTypes : uint8_t {
+    Update = 1, // a single instrument configuration, acknowledged by InstrumentConfigurationAckMessage
+    BatchUpdate = 2, // a batch of configurations, acknowledged by InstrumentConfigurationBatchAckMessage
+    CoalescedAckUpdate = 3, // a single instrument configuration, acknowledged by InstrumentConfigurationCoalescedAckMessage
+    CommitEpoch = 4, // swap the active & shadow configuration banks, acknowledged by CommitEpochAckMessage
+    ReadLatencyHistogram = 5, // read a trigger latency histogram, answered by LatencyHistogramMessage pages
+    ReadNotificationsStatus = 6, // read the notifications status, answered by NotificationsStatusMessage
+    ReadStatistics = 7 // read the statistics counters, answered by StatisticsCountersMessage pages
+};
+
+/// StatisticsCounters module messages types
+enum class StatisticsMessageTypes : uint8_t {
+    Counters = 1, // StatisticsCountersMessage
+    LatencyHistogram = 2 // LatencyHistogramMessage
+};
+
+/// SoftwareTrigger module messages types
+enum class SoftwareTriggerMessageTypes : uint8_t {
+    WithArgs = 1, // TriggerWithArgsMessage, always 96 bytes long
+    CompactWithArgs = 2 // CompactTriggerWithArgsMessage, holding only the arguments present
+};
+
+/// Configuration bank written by a configuration message
+enum class ConfigurationBank : uint8_t {
+    Active = 0, // used by the strategies right away
+    Shadow = 1  // used by the strategies once the epoch is committed, see CommitEpochMessage
+};
+
+/// Acknowledgement requested for an instrument configuration
+enum class ConfigurationAck : uint8_t {
+    None,          // no acknowledgement
+    Immediate,     // an InstrumentConfigurationAckMessage for this configuration
+    Coalesced,     // reported in an InstrumentConfigurationCoalescedAckMessage, sent once a configuration
+                   // out of its instrument ids window is applied or a CoalescedFlush is sent (no timeout)
+    CoalescedFlush // reported as Coalesced, the InstrumentConfigurationCoalescedAckMessage being sent right away
 };
 
 /// CPU To FPGA header
@@ -51,13 +95,13 @@ static_assert(sizeof(CpuToFpgaHeader) == 8, "Invalid CpuToFpgaHeader size");
  * @brief build default cpu to fpga header message of an instrument.
  */
 template <typename T>
-CpuToFpgaHeader buildCpuToFpgaHeader(ModulesIds module) {
+CpuToFpgaHeader buildCpuToFpgaHeader(ModulesIds module, uint8_t msg_type = 1) {
     return {
         /*dest:4       */static_cast<uint8_t>(module),
         /*version:4    */APPLICATION_VERSION,
         /*reserved:3   */1,
         /*ack_request:1*/DEFAULT_ACK,
-        /*msg_type:4   */1,
+        /*msg_type:4   */msg_type,
         /*timestamp    */0, // unused now
         /*length       */sizeof(T)
     };
@@ -72,7 +116,7 @@ struct ENYX_PACKED_STRUCT FpgaToCpuHeader {
     uint8_t error:1;       /// error bit in case message is not processed correctly
     uint8_t msg_type:4;    /// message_type
 
-    uint32_t timestamp;    /// future use : hw timestamp, unused for now.
+    uint32_t timestamp;    /// hw timestamp: FPGA cycle at which the message was emitted
     uint16_t length;       /// message format version
 };
 static_assert(sizeof(FpgaToCpuHeader) == 8, "Invalid FpgaToCpuHeader size");
@@ -100,6 +144,86 @@ struct ENYX_PACKED_STRUCT InstrumentConfigurationMessage {
 };
 static_assert(sizeof(InstrumentConfigurationMessage) == 48, "Invalid InstrumentConfigurationMessage size");
 
+/**
+ * @brief Configuration record of an InstrumentConfigurationBatchMessage.
+ *        Laid out as InstrumentConfigurationMessage, without the header.
+ */
+struct ENYX_PACKED_STRUCT InstrumentConfigurationRecord {
+    std::array<uint8_t, 8> unused; // header of InstrumentConfigurationMessage, ignored
+    InstrumentConfiguration configuration;
+    std::array<uint8_t, 5> reserved; //ensure aligned on 128bits words
+};
+static_assert(sizeof(InstrumentConfigurationRecord) == 48, "Invalid InstrumentConfigurationRecord size");
+
+/**
+ * @brief Message to configure up to MAX_CONFIGURATION_BATCH_SIZE instruments at once.
+ *        Only the first record_count records are sent, see header.length.
+ */
+struct ENYX_PACKED_STRUCT InstrumentConfigurationBatchMessage {
+    CpuToFpgaHeader header = buildCpuToFpgaHeader<InstrumentConfigurationBatchMessage>(ModulesIds::InstrumentDataConfiguration,
+                                                                                       static_cast<uint8_t>(InstrumentConfigurationMessageTypes::BatchUpdate));
+    uint16_t record_count { 0 };          /// Count of records, big endian
+    uint8_t shadow_bank { 0 };            /// Bank written, use enum ConfigurationBank
+    std::array<uint8_t, 5> reserved {{}}; /// Padding
+    std::array<InstrumentConfigurationRecord, MAX_CONFIGURATION_BATCH_SIZE> records;
+};
+static_assert(sizeof(InstrumentConfigurationBatchMessage) == 16 + 48 * MAX_CONFIGURATION_BATCH_SIZE,
+              "Invalid InstrumentConfigurationBatchMessage size");
+static_assert(sizeof(InstrumentConfigurationBatchMessage) <= UINT16_MAX,
+              "InstrumentConfigurationBatchMessage length doesn't fit the header");
+
+/**
+ * @brief Message to swap the active and shadow configuration banks.
+ *        The strategies use the former shadow bank configurations at once,
+ *        and report the epoch id in their notifications. The shadow bank
+ *        then holds the configurations of the previous epoch. The
+ *        configurations written to the active bank are mirrored into the
+ *        shadow bank, so that a commit never reverts them.
+ */
+struct ENYX_PACKED_STRUCT CommitEpochMessage {
+    CpuToFpgaHeader header = buildCpuToFpgaHeader<CommitEpochMessage>(ModulesIds::InstrumentDataConfiguration,
+                                                                      static_cast<uint8_t>(InstrumentConfigurationMessageTypes::CommitEpoch));
+    uint8_t epoch { 0 };                  /// Id of the new epoch
+    std::array<uint8_t, 7> reserved {{}}; /// Padding
+};
+static_assert(sizeof(CommitEpochMessage) == 16, "Invalid CommitEpochMessage size");
+
+/**
+ * @brief Message to read the trigger latency histogram of a module (see
+ *        StatisticsPages::Modules for the modules order), answered by
+ *        LatencyHistogramMessage pages.
+ */
+struct ENYX_PACKED_STRUCT ReadLatencyHistogramMessage {
+    CpuToFpgaHeader header = buildCpuToFpgaHeader<ReadLatencyHistogramMessage>(ModulesIds::InstrumentDataConfiguration,
+                                                                               static_cast<uint8_t>(InstrumentConfigurationMessageTypes::ReadLatencyHistogram));
+    uint8_t module { 0 };                 /// Module of the histogram
+    uint8_t reset { 0 };                  /// Reset the histogram once read
+    std::array<uint8_t, 6> reserved {{}}; /// Padding
+};
+static_assert(sizeof(ReadLatencyHistogramMessage) == 16, "Invalid ReadLatencyHistogramMessage size");
+
+/**
+ * @brief Message to read the notifications status at once, answered by a
+ *        NotificationsStatusMessage.
+ */
+struct ENYX_PACKED_STRUCT ReadNotificationsStatusMessage {
+    CpuToFpgaHeader header = buildCpuToFpgaHeader<ReadNotificationsStatusMessage>(ModulesIds::InstrumentDataConfiguration,
+                                                                                  static_cast<uint8_t>(InstrumentConfigurationMessageTypes::ReadNotificationsStatus));
+    std::array<uint8_t, 8> reserved {{}}; /// Padding
+};
+static_assert(sizeof(ReadNotificationsStatusMessage) == 16, "Invalid ReadNotificationsStatusMessage size");
+
+/**
+ * @brief Message to read the statistics counters at once, answered by
+ *        StatisticsCountersMessage pages.
+ */
+struct ENYX_PACKED_STRUCT ReadStatisticsMessage {
+    CpuToFpgaHeader header = buildCpuToFpgaHeader<ReadStatisticsMessage>(ModulesIds::InstrumentDataConfiguration,
+                                                                         static_cast<uint8_t>(InstrumentConfigurationMessageTypes::ReadStatistics));
+    std::array<uint8_t, 8> reserved {{}}; /// Padding
+};
+static_assert(sizeof(ReadStatisticsMessage) == 16, "Invalid ReadStatisticsMessage size");
+
 /**
  * @brief Message to send to trigger a collection with args.
  *        The size of the message will vary depending on the arg_bitmap.
@@ -113,6 +237,22 @@ struct ENYX_PACKED_STRUCT TriggerWithArgsMessage {
 };
 static_assert(sizeof(TriggerWithArgsMessage) == 96, "Invalid TriggerWithArgsMessage size");
 
+/**
+ * @brief Message to send to trigger a collection with args, holding only
+ *        the arguments set in arg_bitmap, packed from args[0] in increasing
+ *        argument index order. Only header.length bytes are sent: 16 bytes
+ *        plus 16 bytes per argument present.
+ */
+struct ENYX_PACKED_STRUCT CompactTriggerWithArgsMessage {
+    CpuToFpgaHeader       header = buildCpuToFpgaHeader<CompactTriggerWithArgsMessage>(ModulesIds::SoftwareTrigger,
+                                                                                       static_cast<uint8_t>(SoftwareTriggerMessageTypes::CompactWithArgs));
+    uint16_t collection_id { UINT16_MAX };/// Collection Id
+    uint8_t arg_bitmap { 0 };             /// The arguments present in this trigger request. To be mapped directly on the arg_valid bus.
+    std::array<uint8_t, 5> reserved {{}}; /// Padding
+    TriggerArgs args {{}};                /// arguments present, packed
+};
+static_assert(sizeof(CompactTriggerWithArgsMessage) == 96, "Invalid CompactTriggerWithArgsMessage size");
+
 struct ENYX_PACKED_STRUCT InstrumentConfigurationAckMessage {
     struct FpgaToCpuHeader header; //version == 1, msgtype == 1, length ==
     InstrumentConfiguration configuration;
@@ -120,6 +260,115 @@ struct ENYX_PACKED_STRUCT InstrumentConfigurationAckMessage {
 };
 static_assert(sizeof(InstrumentConfigurationAckMessage) == 48, "Invalid InstrumentConfigurationAckMessage size");
 
+/**
+ * @brief Summary acknowledgement of an InstrumentConfigurationBatchMessage.
+ *        The header error bit is set when a record is rejected or the message is truncated.
+ */
+struct ENYX_PACKED_STRUCT InstrumentConfigurationBatchAckMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 2, length == 16
+    uint16_t applied_count; // count of configurations applied
+    uint16_t rejected_count; // count of configurations rejected, no instrument slot left
+    uint32_t first_rejected_instrument_id; // instrument id of the first rejected configuration
+};
+static_assert(sizeof(InstrumentConfigurationBatchAckMessage) == 16, "Invalid InstrumentConfigurationBatchAckMessage size");
+
+
+/**
+ * @brief Coalesced acknowledgement of configurations sent with ConfigurationAck::Coalesced.
+ *        Reports the configurations of the COALESCED_ACK_WINDOW instrument ids starting at
+ *        base_instrument_id. The header error bit is set when a configuration is rejected.
+ */
+struct ENYX_PACKED_STRUCT InstrumentConfigurationCoalescedAckMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 3, length == 32
+    uint32_t base_instrument_id; // instrument id of the bit 0 of the bitmaps
+    uint16_t applied_count; // count of configurations applied
+    uint16_t rejected_count; // count of configurations rejected, no instrument slot left
+    uint64_t applied_bitmap; // bit i set: configuration of instrument base_instrument_id + i applied
+    uint64_t rejected_bitmap; // bit i set: configuration of instrument base_instrument_id + i rejected
+};
+static_assert(sizeof(InstrumentConfigurationCoalescedAckMessage) == 32, "Invalid InstrumentConfigurationCoalescedAckMessage size");
+
+/**
+ * @brief Acknowledgement of a CommitEpochMessage.
+ */
+struct ENYX_PACKED_STRUCT CommitEpochAckMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 4, length == 16
+    uint8_t epoch; // id of the active epoch
+    std::array<uint8_t, 7> reserved;
+};
+static_assert(sizeof(CommitEpochAckMessage) == 16, "Invalid CommitEpochAckMessage size");
+
+/**
+ * @brief Periodic status of the FPGA notifications, also sent on
+ *        AlgorithmDriver::readNotificationsStatus(). The FPGA drops the
+ *        notifications rather than delaying the triggers when the DMA
+ *        egress is slow; dropped counts them per notification bus:
+ *        the strategies, then the configuration acks, the TCP consumer
+ *        the statistics and this status. The configuration acks are never
+ *        dropped, their count stays 0.
+ */
+struct ENYX_PACKED_STRUCT NotificationsStatusMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 1, length == 48
+    uint32_t sequence_number; // status messages emitted since the FPGA reset
+    uint8_t bus_count; // notification buses reported in dropped
+    std::array<uint8_t, 3> reserved;
+    std::array<uint32_t, MAX_NOTIFICATION_BUSES> dropped; // notifications dropped since the FPGA reset, wrapping
+};
+static_assert(sizeof(NotificationsStatusMessage) == 48, "Invalid NotificationsStatusMessage size");
+
+/// Pages of the FPGA statistics counters
+enum class StatisticsPages : uint16_t {
+    Nxbus = 0, // nxbus words, commands & trade summaries
+    NxbusOpcodeClasses = 1, // nxbus commands per opcode class (opcode >> 4), on 2 pages
+    NxbusFull = 3, // cycles each nxbus fan-out output was full
+    Modules = 4 // a page per trigger producer: the strategies, then the configuration & the TCP consumer
+};
+
+/// Counters of the StatisticsPages::Modules pages
+enum class StatisticsModuleCounters : uint8_t {
+    Triggers = 0,
+    DecisionFullCycles = 1, // cycles the trigger bus of the module was full
+    NotificationFullCycles = 2, // cycles the notification bus of the module was full
+    ConfigurationUpdates = 3,
+    SoftwareTriggers = 4,
+    TriggerLatenciesLost = 5 // triggers missing from the latency histogram, the statistics being busy
+};
+
+/**
+ * @brief Page of the periodic FPGA statistics, also sent on
+ *        AlgorithmDriver::readStatistics(). A report is made of
+ *        page_count consecutive pages of the same sequence_number, each
+ *        one timestamped with the cycle it was read. The counters count
+ *        since the FPGA reset, and wrap.
+ */
+struct ENYX_PACKED_STRUCT StatisticsCountersMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 1, length == 48
+    uint32_t sequence_number; // reports emitted since the FPGA reset
+    uint16_t page; // see StatisticsPages
+    uint16_t page_count; // pages of a report
+    std::array<uint32_t, STATISTICS_COUNTERS_PER_PAGE> counters;
+};
+static_assert(sizeof(StatisticsCountersMessage) == 48, "Invalid StatisticsCountersMessage size");
+
+/**
+ * @brief Page of a trigger latency histogram, answer to a
+ *        ReadLatencyHistogramMessage. Bucket i of the histogram counts the
+ *        triggers issued i * bucket_width to (i + 1) * bucket_width - 1
+ *        FPGA cycles after the first word of their market data, the last
+ *        bucket the longer ones. The header error bit is set, and a single
+ *        page sent, for an unknown module.
+ */
+struct ENYX_PACKED_STRUCT LatencyHistogramMessage {
+    struct FpgaToCpuHeader header; //version == 1, msgtype == 2, length == 48
+    uint8_t module; // module of the histogram
+    uint8_t reset; // the histogram was reset once read
+    uint16_t bucket_width; // FPGA cycles per bucket
+    uint16_t page; // index of the page, holding the buckets page * 8 to page * 8 + 7
+    uint16_t page_count; // pages of the histogram
+    std::array<uint32_t, STATISTICS_COUNTERS_PER_PAGE> buckets;
+};
+static_assert(sizeof(LatencyHistogramMessage) == 48, "Invalid LatencyHistogramMessage size");
+
 
 struct ENYX_PACKED_STRUCT TickToCancelNotificationMessage {
     //16B
@@ -132,7 +381,9 @@ struct ENYX_PACKED_STRUCT TickToCancelNotificationMessage {
     uint32_t instrument_id; /// instrument id to trigger on
     uint16_t sent_collection_id; // triggered collection id
     uint8_t is_bid; /// Whether the configuration fot this instrument is enabled or not.
-    std::array<uint8_t, 9> reserved; // pad to ensure 128b
+    uint8_t epoch; /// configuration epoch which triggered
+    uint32_t nxbus_arrival; /// FPGA cycle at which the trade summary reached the strategy
+    std::array<uint8_t, 4> reserved; // pad to ensure 128b
 };
 static_assert(sizeof(TickToCancelNotificationMessage) == 48, "Invalid TickToCancelNotificationMessage size");
 
@@ -145,9 +396,22 @@ struct ENYX_PACKED_STRUCT  TickToTradeNotificationMessage {
     uint32_t instrument_id; /// instrument id to trigger on
     uint16_t sent_collection_id; // triggered collection id
     uint8_t is_bid; /// Whether the configuration fot this instrument is enabled or not.
-    std::array<uint8_t, 1> reserved; //ensure aligned on 128bits words
+    uint8_t epoch; /// configuration epoch which triggered
+    //16B
+    uint32_t nxbus_arrival; /// FPGA cycle at which the trade summary reached the strategy
+    std::array<uint8_t, 12> reserved; // pad to ensure 128b
 };
-static_assert(sizeof(TickToTradeNotificationMessage) == 32, "Invalid TickToTradeNotificationMessage size");
+static_assert(sizeof(TickToTradeNotificationMessage) == 48, "Invalid TickToTradeNotificationMessage size");
+
+/**
+ * @brief Wire to decision latency of a trigger, in FPGA cycles: from the
+ *        trade summary arrival to the trigger emission (header.timestamp).
+ */
+uint32_t
+decisionLatency(const TickToCancelNotificationMessage&);
+
+uint32_t
+decisionLatency(const TickToTradeNotificationMessage&);
 
 std::ostream&
 operator<<(std::ostream&, const InstrumentConfiguration&);
@@ -155,6 +419,24 @@ operator<<(std::ostream&, const InstrumentConfiguration&);
 std::ostream&
 operator<<(std::ostream&, const InstrumentConfigurationAckMessage&);
 
+std::ostream&
+operator<<(std::ostream&, const InstrumentConfigurationBatchAckMessage&);
+
+std::ostream&
+operator<<(std::ostream&, const InstrumentConfigurationCoalescedAckMessage&);
+
+std::ostream&
+operator<<(std::ostream&, const CommitEpochAckMessage&);
+
+std::ostream&
+operator<<(std::ostream&, const NotificationsStatusMessage&);
+
+std::ostream&
+operator<<(std::ostream&, const StatisticsCountersMessage&);
+
+std::ostream&
+operator<<(std::ostream&, const LatencyHistogramMessage&);
+
 std::ostream&
 operator<<(std::ostream&, const TickToCancelNotificationMessage&);
 
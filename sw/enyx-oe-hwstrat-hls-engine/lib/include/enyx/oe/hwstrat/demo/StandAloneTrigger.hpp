@@ -13,15 +13,13 @@
 #include <enyx/hw/c2a_stream.hpp>
 
 #include <enyx/oe/hwstrat/demo/Protocol.hpp>
+#include <enyx/oe/hwstrat/demo/TriggerTemplate.hpp>
 
 namespace enyx {
 namespace oe {
 namespace hwstrat {
 namespace demo {
 
-using DataView = enyx::utils::BufferView<const uint8_t>;
-using DataArgViews = std::array<DataView, TRIGGER_NB_ARG>;
-
 /**
  * @brief Class to trigger a collection with arg using the hls demo firmware.
  *        This class cannot be instantiated with AlgorithmDriver since they both will try
@@ -61,9 +59,22 @@ public:
     std::error_code
     trigger(uint16_t collection_id, const DataArgViews& args);
 
+    /**
+     * @brief Trigger a collection from a registered template, as patched.
+     *
+     * @param handle Handle of the template, returned by templates().add().
+     * @return std::error_code An error code.  User shall retry when error code is [ std::errc::resource_unavailable_try_again ].
+     */
+    std::error_code
+    trigger(TriggerTemplateHandle handle);
+
+    /** @brief The trigger templates, to register and patch them. */
+    TriggerTemplates&
+    templates() { return templates_; }
+
     /**
      * @brief Static method to trigger an collection using the sandbox with some arguments.
-     *        Depending on the number of argument, the message sent will have a different size.
+     *        Only the arguments present are sent (see CompactTriggerWithArgsMessage).
      *
      * @param stream stream to use to send the trigger.
      * @param collection_id Id of the collection to trigger
@@ -87,6 +98,10 @@ public:
     static std::error_code
     trigger_helper(enyx::hw::c2a_stream& stream, uint16_t collection_id, const DataArgViews& args);
 
+    /** @brief same as trigger_helper using a trigger template */
+    static std::error_code
+    trigger_helper(enyx::hw::c2a_stream& stream, const TriggerTemplate& trigger_template);
+
     static bool
     bind_arguments(TriggerWithArgsMessage& out,
         uint16_t collection_id,
@@ -100,9 +115,27 @@ public:
     static bool
     bind_arguments(TriggerWithArgsMessage& trigger_msg, uint16_t collection_id, const DataArgViews& args);
 
+    /**
+     * @brief Bind the arguments present to a compact trigger message,
+     *        and size the message accordingly.
+     */
+    static bool
+    bind_arguments(CompactTriggerWithArgsMessage& out,
+        uint16_t collection_id,
+        const DataView& arg0,
+        const DataView& arg1 = {},
+        const DataView& arg2 = {},
+        const DataView& arg3 = {},
+        const DataView& arg4 = {});
+
+    /** @brief same as bind_arguments using array of args */
+    static bool
+    bind_arguments(CompactTriggerWithArgsMessage& trigger_msg, uint16_t collection_id, const DataArgViews& args);
+
 private:
     enyx::hw::accelerator accelerator_;
     enyx::hw::c2a_stream stream_;
+    TriggerTemplates templates_;
 };
 
 
@@ -0,0 +1,142 @@
+/** @file
+ *  @brief Contains TriggerTemplate and TriggerTemplates.
+ *  @date 2021
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <type_traits>
+
+#include <enyx/utils/BufferView.hpp>
+
+#include <enyx/oe/hwstrat/demo/Protocol.hpp>
+
+namespace enyx {
+namespace oe {
+namespace hwstrat {
+namespace demo {
+
+using DataView = enyx::utils::BufferView<const uint8_t>;
+using DataArgViews = std::array<DataView, TRIGGER_NB_ARG>;
+
+/// Identifies a trigger template registered in TriggerTemplates.
+using TriggerTemplateHandle = std::size_t;
+
+/**
+ * @brief Software trigger message laid out once, at registration.
+ *        On the hot path, only the changed bytes of its arguments
+ *        (e.g. a price or a client order id) are patched before sending.
+ */
+class TriggerTemplate {
+public:
+
+    /**
+     * @brief Lay out the trigger message.
+     *
+     * @param collection_id Id of the collection to trigger
+     * @param args Arguments of the trigger, empty buffers being absent arguments.
+     * @throw std::invalid_argument if an argument is longer than TRIGGER_ARG_SIZE.
+     */
+    TriggerTemplate(uint16_t collection_id, const DataArgViews& args);
+
+    /**
+     * @brief Overwrite bytes of an argument.
+     *
+     * @param arg_index Index of the argument, which shall be present in the template.
+     * @param offset Offset of the first byte written in the argument.
+     * @param bytes Bytes to write, offset + bytes.size() shall not exceed TRIGGER_ARG_SIZE.
+     */
+    void
+    patch(std::size_t arg_index, std::size_t offset, const DataView& bytes);
+
+    /**
+     * @brief Overwrite bytes of an argument with an integer, written big endian
+     *        as the argument bytes are mapped most significant first on the trigger bus.
+     *
+     * @param arg_index Index of the argument, which shall be present in the template.
+     * @param offset Offset of the most significant byte in the argument.
+     * @param value Value to write, offset + sizeof(value) shall not exceed TRIGGER_ARG_SIZE.
+     */
+    template<typename Integer>
+    void
+    patch(std::size_t arg_index, std::size_t offset, Integer value);
+
+    /** @brief The message to send, header.length bytes long. */
+    const CompactTriggerWithArgsMessage&
+    message() const { return message_; }
+
+private:
+    uint8_t *
+    argument(std::size_t arg_index, std::size_t offset, std::size_t size);
+
+private:
+    CompactTriggerWithArgsMessage message_;
+    std::array<uint8_t, TRIGGER_NB_ARG> arg_slots_; /// position of each argument in the packed arguments
+};
+
+/**
+ * @brief Registry of trigger templates. The handles, and the references
+ *        returned by operator[], stay valid as long as the registry,
+ *        whatever the templates added afterwards.
+ */
+class TriggerTemplates {
+public:
+
+    /**
+     * @brief Register a trigger template.
+     *
+     * @param collection_id Id of the collection to trigger
+     * @param args Arguments of the trigger, empty buffers being absent arguments.
+     * @return The handle of the template.
+     * @throw std::invalid_argument if an argument is longer than TRIGGER_ARG_SIZE.
+     */
+    TriggerTemplateHandle
+    add(uint16_t collection_id, const DataArgViews& args);
+
+    /** @brief Access the template of a handle, to patch it. */
+    TriggerTemplate&
+    operator[](TriggerTemplateHandle handle) { return templates_[handle]; }
+
+    const TriggerTemplate&
+    operator[](TriggerTemplateHandle handle) const { return templates_[handle]; }
+
+    std::size_t
+    size() const { return templates_.size(); }
+
+private:
+    std::deque<TriggerTemplate> templates_; /// a deque never moves its elements on add()
+};
+
+inline uint8_t *
+TriggerTemplate::argument(std::size_t arg_index, std::size_t offset, std::size_t size) {
+    assert(arg_index < TRIGGER_NB_ARG && (message_.arg_bitmap & (1 << arg_index)) && "Argument absent from the template");
+    assert(offset + size <= TRIGGER_ARG_SIZE && "Patch out of the argument");
+    (void)size;
+    return message_.args[arg_slots_[arg_index]].data() + offset;
+}
+
+inline void
+TriggerTemplate::patch(std::size_t arg_index, std::size_t offset, const DataView& bytes) {
+    std::memcpy(argument(arg_index, offset, bytes.size()), bytes.data(), bytes.size());
+}
+
+template<typename Integer>
+inline void
+TriggerTemplate::patch(std::size_t arg_index, std::size_t offset, Integer value) {
+    static_assert(std::is_integral<Integer>::value, "Only integers can be patched by value");
+    uint8_t * const data = argument(arg_index, offset, sizeof(value));
+    for (std::size_t i = 0; i < sizeof(value); ++i) {
+        data[i] = static_cast<uint8_t>(value >> (8 * (sizeof(value) - 1 - i)));
+    }
+}
+
+} // namespace demo
+} // namespace hwstrat
+} // namespace oe
+} // namespace enyx
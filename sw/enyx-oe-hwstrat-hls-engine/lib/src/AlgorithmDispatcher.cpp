@@ -18,30 +18,55 @@ void
 AlgorithmDispatcher::operator()(const uint8_t * data, uint32_t size) {
     using HeaderType = FpgaToCpuHeader;
 
-    if (size <= sizeof(HeaderType)) {
-        handler_.onError(make_error_code(CORRUPTED_APPLICATION_HEADER));
-        return;
-    }
-
     // This log can potentially impact performance, so please remove it for production use.
-    LOG_ME(NX_DEBUG, "[AlgorithmDispatcher] Raw content of received message : %s",
+    LOG_ME(NX_DEBUG, "[AlgorithmDispatcher] Raw content of received packet : %s",
            enyx::utils::data_format::toHexString({data, size}).c_str());
 
-    const auto * header = reinterpret_cast<const HeaderType*>(data);
+    // Messages are packed back to back, each one starting with its header
+    do {
+        if (size <= sizeof(HeaderType)) {
+            handler_.onError(make_error_code(CORRUPTED_APPLICATION_HEADER));
+            return;
+        }
+
+        const auto * header = reinterpret_cast<const HeaderType*>(data);
+        const uint32_t length = be16toh(header->length);
 
-    // Sanity check
-    if (be16toh(header->length) != size
-            || header->version != APPLICATION_VERSION) {
-        LOG_ME(NX_CRITICAL, "[AlgorithmDispatcher] Corrupted application header: version: %d"
-            " length: %d  buffer size: %d", header->version, header->length, size);
-        handler_.onError(make_error_code(CORRUPTED_APPLICATION_HEADER));
-        return;
-    }
+        // Sanity check
+        if (length <= sizeof(HeaderType) || length > size
+                || header->version != APPLICATION_VERSION) {
+            LOG_ME(NX_CRITICAL, "[AlgorithmDispatcher] Corrupted application header: version: %d"
+                " length: %d  buffer size: %d", header->version, length, size);
+            handler_.onError(make_error_code(CORRUPTED_APPLICATION_HEADER));
+            return;
+        }
+
+        dispatch(data);
+        data += length;
+        size -= length;
+    } while (size != 0);
+}
+
+void
+AlgorithmDispatcher::dispatch(const uint8_t * data) {
+    const auto * header = reinterpret_cast<const FpgaToCpuHeader*>(data);
 
     switch (static_cast<ModulesIds>(header->source)) {
         case ModulesIds::InstrumentDataConfiguration:
-            handler_.on(*reinterpret_cast<const InstrumentConfigurationAckMessage*>(data));
-            return;
+            switch (static_cast<InstrumentConfigurationMessageTypes>(header->msg_type)) {
+                case InstrumentConfigurationMessageTypes::BatchUpdate:
+                    handler_.on(*reinterpret_cast<const InstrumentConfigurationBatchAckMessage*>(data));
+                    return;
+                case InstrumentConfigurationMessageTypes::CoalescedAckUpdate:
+                    handler_.on(*reinterpret_cast<const InstrumentConfigurationCoalescedAckMessage*>(data));
+                    return;
+                case InstrumentConfigurationMessageTypes::CommitEpoch:
+                    handler_.on(*reinterpret_cast<const CommitEpochAckMessage*>(data));
+                    return;
+                default:
+                    handler_.on(*reinterpret_cast<const InstrumentConfigurationAckMessage*>(data));
+                    return;
+            }
         case ModulesIds::SoftwareTrigger:
             LOG_ME(NX_CRITICAL, "[AlgorithmDispatcher] Received unexpected Software Trigger message");
             handler_.onError(make_error_code(UNKNOWN_ALGORITHM_MESSAGE));
@@ -52,6 +77,18 @@ AlgorithmDispatcher::operator()(const uint8_t * data, uint32_t size) {
         case ModulesIds::TickToTrade:
             handler_.on(*reinterpret_cast<const TickToTradeNotificationMessage*>(data));
             return;
+        case ModulesIds::NotificationsStatus:
+            handler_.on(*reinterpret_cast<const NotificationsStatusMessage*>(data));
+            return;
+        case ModulesIds::StatisticsCounters:
+            switch (static_cast<StatisticsMessageTypes>(header->msg_type)) {
+                case StatisticsMessageTypes::LatencyHistogram:
+                    handler_.on(*reinterpret_cast<const LatencyHistogramMessage*>(data));
+                    return;
+                default:
+                    handler_.on(*reinterpret_cast<const StatisticsCountersMessage*>(data));
+                    return;
+            }
     }
     LOG_ME(NX_CRITICAL, "[AlgorithmDispatcher] Message received with unknown source: %d", header->source);
     handler_.onError(make_error_code(UNKNOWN_ALGORITHM_MESSAGE));
@@ -71,11 +71,15 @@ AlgorithmDriver::poll() {
 }
 
 std::error_code
-AlgorithmDriver::sendConfiguration(const InstrumentConfiguration & conf) {
+AlgorithmDriver::sendConfiguration(const InstrumentConfiguration & conf,
+                                   ConfigurationAck ack) {
 
     InstrumentConfigurationMessage update;
 
-    // Header filled at construction
+    // Header filled at construction, but the acknowledgement
+    update.header.ack_request = ack != ConfigurationAck::None && ack != ConfigurationAck::Coalesced;
+    if (ack == ConfigurationAck::Coalesced || ack == ConfigurationAck::CoalescedFlush)
+        update.header.msg_type = static_cast<uint8_t>(InstrumentConfigurationMessageTypes::CoalescedAckUpdate);
 
     //body
     update.configuration = conf;
@@ -83,12 +87,90 @@ AlgorithmDriver::sendConfiguration(const InstrumentConfiguration & conf) {
     return sendToFpga(c2a_stream_, update);
 }
 
+std::error_code
+AlgorithmDriver::sendConfigurations(const std::vector<InstrumentConfiguration> & updates,
+                                    ConfigurationBank bank) {
+
+    InstrumentConfigurationBatchMessage batch{};
+    batch.shadow_bank = static_cast<uint8_t>(bank);
+    const size_t header_size = sizeof(batch) - sizeof(batch.records);
+
+    for (size_t first = 0; first < updates.size(); first += MAX_CONFIGURATION_BATCH_SIZE) {
+        const size_t count = std::min(MAX_CONFIGURATION_BATCH_SIZE, updates.size() - first);
+
+        // Header filled at construction, only the records present are sent
+        batch.header.length = header_size + count * sizeof(InstrumentConfigurationRecord);
+        batch.record_count = htobe16(count);
+        for (size_t i = 0; i != count; ++i)
+            batch.records[i].configuration = updates[first + i];
+
+        const auto err = sendToFpga(c2a_stream_, batch);
+        if (err)
+            return err;
+    }
+
+    return {};
+}
+
+std::error_code
+AlgorithmDriver::commitEpoch(uint8_t epoch) {
+
+    CommitEpochMessage commit;
+
+    // Header filled at construction
+    commit.epoch = epoch;
+
+    return sendToFpga(c2a_stream_, commit);
+}
+
+std::error_code
+AlgorithmDriver::readLatencyHistogram(uint8_t module, bool reset) {
+
+    ReadLatencyHistogramMessage read;
+
+    // Header filled at construction
+    read.module = module;
+    read.reset = reset;
+
+    return sendToFpga(c2a_stream_, read);
+}
+
+std::error_code
+AlgorithmDriver::readNotificationsStatus() {
+
+    // Header filled at construction
+    ReadNotificationsStatusMessage read;
+
+    return sendToFpga(c2a_stream_, read);
+}
+
+std::error_code
+AlgorithmDriver::readStatistics() {
+
+    // Header filled at construction
+    ReadStatisticsMessage read;
+
+    return sendToFpga(c2a_stream_, read);
+}
+
 std::error_code
 AlgorithmDriver::trigger(const TriggerWithArgsMessage& to_send) {
 
     return sendToFpga(c2a_stream_, to_send);
 }
 
+std::error_code
+AlgorithmDriver::trigger(const CompactTriggerWithArgsMessage& to_send) {
+
+    return sendToFpga(c2a_stream_, to_send);
+}
+
+std::error_code
+AlgorithmDriver::trigger(TriggerTemplateHandle handle) {
+
+    return sendToFpga(c2a_stream_, trigger_templates_[handle].message());
+}
+
 std::error_code
 AlgorithmDriver::trigger(uint16_t collection_id,
                          const utils::BufferView<const uint8_t>& arg0,
@@ -97,7 +179,7 @@ AlgorithmDriver::trigger(uint16_t collection_id,
                          const utils::BufferView<const uint8_t>& arg3,
                          const utils::BufferView<const uint8_t>& arg4) {
 
-    TriggerWithArgsMessage to_send;
+    CompactTriggerWithArgsMessage to_send;
     const bool binded = StandAloneTrigger::bind_arguments(to_send, collection_id, arg0, arg1, arg2, arg3, arg4);
     if(not binded) {
         return std::make_error_code(std::errc::invalid_argument);
@@ -37,6 +37,72 @@ operator<<(std::ostream& os, const InstrumentConfigurationAckMessage& v) {
     return os;
 }
 
+std::ostream&
+operator<<(std::ostream& os, const InstrumentConfigurationBatchAckMessage& v) {
+    os << v.header
+       <<  " applied_count:" << be16toh(v.applied_count)
+       <<  " rejected_count:" << be16toh(v.rejected_count)
+       <<  " first_rejected_instrument_id:" << be32toh(v.first_rejected_instrument_id);
+    return os;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const InstrumentConfigurationCoalescedAckMessage& v) {
+    os << v.header
+       <<  " base_instrument_id:" << be32toh(v.base_instrument_id)
+       <<  " applied_count:" << be16toh(v.applied_count)
+       <<  " rejected_count:" << be16toh(v.rejected_count)
+       <<  std::hex
+       <<  " applied_bitmap:0x" << be64toh(v.applied_bitmap)
+       <<  " rejected_bitmap:0x" << be64toh(v.rejected_bitmap)
+       <<  std::dec;
+    return os;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const CommitEpochAckMessage& v) {
+    os << v.header
+       <<  " epoch:" << uint32_t(v.epoch);
+    return os;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const NotificationsStatusMessage& v) {
+    os << v.header
+       <<  " sequence_number:" << be32toh(v.sequence_number)
+       <<  " dropped:";
+    for (std::size_t i = 0; i < v.bus_count && i < v.dropped.size(); ++i) {
+        os << " " << be32toh(v.dropped[i]);
+    }
+    return os;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const StatisticsCountersMessage& v) {
+    os << v.header
+       <<  " sequence_number:" << be32toh(v.sequence_number)
+       <<  " page:" << be16toh(v.page) << "/" << be16toh(v.page_count)
+       <<  " counters:";
+    for (const uint32_t counter : v.counters) {
+        os << " " << be32toh(counter);
+    }
+    return os;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const LatencyHistogramMessage& v) {
+    os << v.header
+       <<  " module:" << uint32_t(v.module)
+       <<  " reset:" << uint32_t(v.reset)
+       <<  " bucket_width:" << be16toh(v.bucket_width)
+       <<  " page:" << be16toh(v.page) << "/" << be16toh(v.page_count)
+       <<  " buckets:";
+    for (const uint32_t bucket : v.buckets) {
+        os << " " << be32toh(bucket);
+    }
+    return os;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const TickToCancelNotificationMessage& v) {
     os << v.header
@@ -45,7 +111,10 @@ operator<<(std::ostream& os, const TickToCancelNotificationMessage& v) {
        <<  " threshold:" << be64toh(v.threshold)
        <<  " instrument_id:" << be32toh(v.instrument_id)
        <<  " sent_collection_id:" << be16toh(v.sent_collection_id)
-       <<  " is_bid:" << uint32_t(v.is_bid);
+       <<  " is_bid:" << uint32_t(v.is_bid)
+       <<  " epoch:" << uint32_t(v.epoch)
+       <<  " nxbus_arrival:" << be32toh(v.nxbus_arrival)
+       <<  " latency:" << decisionLatency(v);
     return os;
 }
 
@@ -57,10 +126,24 @@ operator<<(std::ostream& os, const TickToTradeNotificationMessage& v) {
        <<  " threshold_price:" << be64toh(v.threshold_price)
        <<  " instrument_id:" << be32toh(v.instrument_id)
        <<  " sent_collection_id:" << be16toh(v.sent_collection_id)
-       <<  " is_bid:" << uint32_t(v.is_bid);
+       <<  " is_bid:" << uint32_t(v.is_bid)
+       <<  " epoch:" << uint32_t(v.epoch)
+       <<  " nxbus_arrival:" << be32toh(v.nxbus_arrival)
+       <<  " latency:" << decisionLatency(v);
     return os;
 }
 
+uint32_t
+decisionLatency(const TickToCancelNotificationMessage& v) {
+    // the FPGA cycle counter wraps, so does the difference
+    return be32toh(v.header.timestamp) - be32toh(v.nxbus_arrival);
+}
+
+uint32_t
+decisionLatency(const TickToTradeNotificationMessage& v) {
+    return be32toh(v.header.timestamp) - be32toh(v.nxbus_arrival);
+}
+
 std::ostream&
 operator<<(std::ostream& os, const InstrumentConfiguration& v) {
     os << "t2c_threshold:" << be64toh(v.price_threshold)
@@ -45,11 +45,52 @@ StandAloneTrigger::bind_arguments(TriggerWithArgsMessage& trigger_msg, uint16_t
     return true;
 }
 
+bool
+StandAloneTrigger::bind_arguments(CompactTriggerWithArgsMessage& out,
+    uint16_t collection_id,
+    const DataView& arg0,
+    const DataView& arg1,
+    const DataView& arg2,
+    const DataView& arg3,
+    const DataView& arg4) {
+    return bind_arguments(out, collection_id, {arg0, arg1, arg2, arg3, arg4});
+}
+
+bool
+StandAloneTrigger::bind_arguments(CompactTriggerWithArgsMessage& trigger_msg, uint16_t collection_id, const DataArgViews& args) {
+
+    trigger_msg.collection_id = collection_id;
+
+    // Fill the arguments present, packed
+    size_t arg_count = 0;
+    for (size_t i = 0; i < args.size(); ++i) {
+
+        if (args[i].size() != 0 && args[i].data() != nullptr) {
+            if (args[i].size() > TRIGGER_ARG_SIZE) {
+                return false;
+            }
+            trigger_msg.arg_bitmap |= 1 << i;
+            for (uint8_t i_val = 0; i_val< args[i].size(); ++i_val) {
+                trigger_msg.args[arg_count][i_val] = args[i].data()[i_val];
+            }
+            ++arg_count;
+        }
+    }
+
+    trigger_msg.header.length = sizeof(trigger_msg) - sizeof(trigger_msg.args) + arg_count * TRIGGER_ARG_SIZE;
+    return true;
+}
+
 std::error_code
 StandAloneTrigger::trigger(uint16_t collection_id, const DataArgViews& args) {
     return trigger_helper(stream_, collection_id, args);
 }
 
+std::error_code
+StandAloneTrigger::trigger(TriggerTemplateHandle handle) {
+    return trigger_helper(stream_, templates_[handle]);
+}
+
 std::error_code
 StandAloneTrigger::trigger_helper(enyx::hw::c2a_stream& stream,
                uint16_t collection_id,
@@ -65,7 +106,7 @@ inline
 std::error_code
 StandAloneTrigger::trigger_helper(enyx::hw::c2a_stream& stream, uint16_t collection_id, const DataArgViews& args) {
 
-    TriggerWithArgsMessage trigger_msg;
+    CompactTriggerWithArgsMessage trigger_msg;
     const bool binded = bind_arguments(trigger_msg, collection_id, args);
     if(not binded) {
         return std::make_error_code(std::errc::invalid_argument);
@@ -73,6 +114,13 @@ StandAloneTrigger::trigger_helper(enyx::hw::c2a_stream& stream, uint16_t collect
     return stream.send(reinterpret_cast<const void*>(&trigger_msg), trigger_msg.header.length).error();
 }
 
+std::error_code
+StandAloneTrigger::trigger_helper(enyx::hw::c2a_stream& stream, const TriggerTemplate& trigger_template) {
+
+    const CompactTriggerWithArgsMessage& trigger_msg = trigger_template.message();
+    return stream.send(reinterpret_cast<const void*>(&trigger_msg), trigger_msg.header.length).error();
+}
+
 } // namespace demo
 } // namespace hwstrat
 } // namespace oe
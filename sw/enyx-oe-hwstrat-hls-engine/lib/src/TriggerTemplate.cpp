@@ -0,0 +1,42 @@
+#include <enyx/oe/hwstrat/demo/TriggerTemplate.hpp>
+
+
+namespace enyx {
+namespace oe {
+namespace hwstrat {
+namespace demo {
+
+TriggerTemplate::TriggerTemplate(uint16_t collection_id, const DataArgViews& args)
+    : message_()
+    , arg_slots_() {
+
+    message_.collection_id = collection_id;
+
+    // Lay out the arguments present, packed
+    uint8_t arg_count = 0;
+    for (size_t i = 0; i < args.size(); ++i) {
+
+        if (args[i].size() != 0 && args[i].data() != nullptr) {
+            if (args[i].size() > TRIGGER_ARG_SIZE) {
+                throw std::invalid_argument("Trigger template argument longer than 16 bytes");
+            }
+            message_.arg_bitmap |= 1 << i;
+            std::memcpy(message_.args[arg_count].data(), args[i].data(), args[i].size());
+            arg_slots_[i] = arg_count;
+            ++arg_count;
+        }
+    }
+
+    message_.header.length = sizeof(message_) - sizeof(message_.args) + arg_count * TRIGGER_ARG_SIZE;
+}
+
+TriggerTemplateHandle
+TriggerTemplates::add(uint16_t collection_id, const DataArgViews& args) {
+    templates_.emplace_back(collection_id, args);
+    return templates_.size() - 1;
+}
+
+} // namespace demo
+} // namespace hwstrat
+} // namespace oe
+} // namespace enyx
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include <enyx/oe/hwstrat/demo/StandAloneTrigger.hpp>
+#include <enyx/oe/hwstrat/demo/TriggerTemplate.hpp>
+
+namespace demo = enyx::oe::hwstrat::demo;
+
+// Trigger of a host initiated order: the price and the client order id change on each order
+const uint16_t collection_id = 0x0042;
+const std::size_t price_offset = 0;
+const std::size_t client_order_id_offset = 8;
+
+volatile uint8_t sink; // prevents the messages building from being optimized out
+
+void usage(const char* prog_name) {
+    std::cout << "Usage: " << prog_name  << " [iterations] [accelerator_id]\n"
+        << "Measure the software cost of a trigger with one argument, whose price & client order id change\n"
+        << "on each trigger: built from scratch (full and compact messages), or patched from a template.\n"
+        << "When accelerator_id is provided, the template triggers are also sent to the FPGA.\n";
+}
+
+template<typename Message>
+void consume(const Message& message) {
+    const uint8_t * const data = reinterpret_cast<const uint8_t *>(&message);
+    sink = data[0] ^ data[message.header.length - 1];
+}
+
+void fill_argument(std::array<uint8_t, demo::TRIGGER_ARG_SIZE>& argument, uint64_t price, uint64_t client_order_id) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        argument[price_offset + i] = static_cast<uint8_t>(price >> (8 * (7 - i)));
+        argument[client_order_id_offset + i] = static_cast<uint8_t>(client_order_id >> (8 * (7 - i)));
+    }
+}
+
+template<typename Function>
+void measure(const char * name, std::size_t iterations, Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        function(i);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << std::left << std::setw(32) << name
+              << std::fixed << std::setprecision(1) << elapsed_ns / iterations << " ns/trigger\n";
+}
+
+int main(int argc, char ** argv) {
+
+    if (argc > 3) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 10000000;
+    if (iterations == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::array<uint8_t, demo::TRIGGER_ARG_SIZE> argument{};
+        const demo::DataArgViews args = {{ demo::DataView{argument.data(), argument.size()} }};
+
+        measure("full message, bind_arguments", iterations, [&] (std::size_t i) {
+            fill_argument(argument, 1000 + i, i);
+            demo::TriggerWithArgsMessage message;
+            demo::StandAloneTrigger::bind_arguments(message, collection_id, args);
+            consume(message);
+        });
+
+        measure("compact message, bind_arguments", iterations, [&] (std::size_t i) {
+            fill_argument(argument, 1000 + i, i);
+            demo::CompactTriggerWithArgsMessage message;
+            demo::StandAloneTrigger::bind_arguments(message, collection_id, args);
+            consume(message);
+        });
+
+        demo::TriggerTemplates templates;
+        const demo::TriggerTemplateHandle handle = templates.add(collection_id, args);
+        measure("template, patch", iterations, [&] (std::size_t i) {
+            demo::TriggerTemplate& order = templates[handle];
+            order.patch(0, price_offset, uint64_t(1000 + i));
+            order.patch(0, client_order_id_offset, uint64_t(i));
+            consume(order.message());
+        });
+
+        if (argc > 2) {
+            demo::StandAloneTrigger trigger(std::atoi(argv[2]));
+            const demo::TriggerTemplateHandle sent_handle = trigger.templates().add(collection_id, args);
+            measure("template, patch & send", iterations, [&] (std::size_t i) {
+                demo::TriggerTemplate& order = trigger.templates()[sent_handle];
+                order.patch(0, price_offset, uint64_t(1000 + i));
+                order.patch(0, client_order_id_offset, uint64_t(i));
+                std::error_code failure;
+                do {
+                    failure = trigger.trigger(sent_handle);
+                } while (failure == std::errc::resource_unavailable_try_again);
+                if (failure) {
+                    throw std::system_error(failure, "Can't send trigger");
+                }
+            });
+        }
+    } catch (std::exception& e) {
+        std::cerr << "Unexpected exception caught: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}